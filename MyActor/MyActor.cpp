@@ -1,4 +1,7 @@
 #include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include "./actor/my_actor.h"
 #include "./actor/actor_socket.h"
 #include "./actor/async_timer.h"
@@ -761,10 +764,20 @@ void udp_test()
 	trace_line("end udp_test");
 }
 
-void perfor_test()
+const char* engine_mode_name(io_engine::engine_mode mode)
 {
-	trace_line("begin perfor_test");
-	io_engine ios;
+	switch (mode)
+	{
+	case io_engine::work_steal: return "work_steal";
+	case io_engine::sharded: return "sharded";
+	default: return "asio_strand";
+	}
+}
+
+void perfor_test(io_engine::engine_mode mode)
+{
+	trace_line("begin perfor_test ", engine_mode_name(mode));
+	io_engine ios(true, "perfor_test", mode);
 	ios.run(run_thread::cpu_thread_number());
 	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
 	{
@@ -803,7 +816,7 @@ void perfor_test()
 	ah->run();
 	ah->outside_wait_quit();
 	ios.stop();
-	trace_line("end perfor_test");
+	trace_line("end perfor_test ", engine_mode_name(mode));
 }
 
 void async_timer_test()
@@ -861,6 +874,163 @@ void async_timer_test()
 	trace_line("end async_timer_test");
 }
 
+void timer_cancel_test()
+{
+	trace_line("begin timer_cancel_test");
+	io_engine ios;
+	ios.run(1);
+	shared_strand strand = boost_strand::create(ios);
+	strand->post([strand]
+	{
+		//ʱڴǰȡENABLE_TIMER_WHEEL²ȡΪO(1)
+		const int num = 500000;
+		overlap_timer* const timer = strand->over_timer();
+		std::unique_ptr<overlap_timer::timer_handle[]> handles(new overlap_timer::timer_handle[num]);
+		long long tk = get_tick_us();
+		for (int i = 0; i < num; i++)
+		{
+			timer->utimeout(1000000 + (i * 7919) % 30000000, handles[i], []{});
+		}
+		for (int i = 0; i < num; i++)
+		{
+			timer->cancel(handles[i]);
+		}
+		trace_line("timeout+cancel ", (double)(get_tick_us() - tk) * 1000 / num, "ns");
+	});
+	ios.stop();
+	trace_line("end timer_cancel_test");
+}
+
+void timer_slack_test()
+{
+	trace_line("begin timer_slack_test");
+	io_engine ios;
+	ios.run();
+	for (long long slack = 0; slack <= 5000; slack += 5000)
+	{
+		//ඨʱӳ٣޺ϲͬһλ
+		boost_strand::default_timer_slack(slack);
+		std::atomic<long long> lateSum(0);
+		std::atomic<long long> count(0);
+		std::list<actor_handle> actors;
+		for (int i = 0; i < 1000; i++)
+		{
+			actors.push_back(my_actor::create(boost_strand::create(ios), [&, i](my_actor* self)
+			{
+				for (int j = 0; j < 10; j++)
+				{
+					long long tk = get_tick_us();
+					self->sleep(10 + (i + j) % 7);
+					lateSum += get_tick_us() - tk - (10 + (i + j) % 7) * 1000;
+					count++;
+				}
+			}));
+		}
+		for (auto& ele : actors)
+		{
+			ele->run();
+		}
+		for (auto& ele : actors)
+		{
+			ele->outside_wait_quit();
+		}
+		trace_line("slack ", slack, "us, average late ", lateSum / count, "us");
+	}
+	boost_strand::default_timer_slack(0);
+	ios.stop();
+	trace_line("end timer_slack_test");
+}
+
+void shared_timer_test()
+{
+	trace_line("begin shared_timer_test");
+	io_engine ios;
+	ios.run();
+	//strandԶʱENABLE_SHARED_TIMERͬһio_serviceֻռһasioʱ
+	std::atomic<long long> lateSum(0);
+	std::atomic<long long> count(0);
+	std::list<actor_handle> actors;
+	long long tk = get_tick_us();
+	for (int i = 0; i < 10000; i++)
+	{
+		actors.push_back(my_actor::create(boost_strand::create(ios), [&, i](my_actor* self)
+		{
+			for (int j = 0; j < 5; j++)
+			{
+				long long st = get_tick_us();
+				self->sleep(1 + (i + j) % 20);
+				lateSum += get_tick_us() - st - (1 + (i + j) % 20) * 1000;
+				count++;
+			}
+		}));
+	}
+	for (auto& ele : actors)
+	{
+		ele->run();
+	}
+	for (auto& ele : actors)
+	{
+		ele->outside_wait_quit();
+	}
+	trace_line("strands ", actors.size(), ", total ", (get_tick_us() - tk) / 1000, "ms, average late ", lateSum / count, "us");
+#ifdef DISABLE_BOOST_TIMER
+	std::vector<waitable_timer_stats> stats = ios.waitableTimerStats();
+	for (size_t i = 0; i < stats.size(); i++)
+	{
+		trace_line("timer shard ", i, ": fire ", stats[i].fireCount, ", wake ", stats[i].wakeCount, ", max batch ", stats[i].maxBatch,
+			", max late ", stats[i].maxLate, "us, max hold ", stats[i].maxHold, "us");
+	}
+#endif
+	ios.stop();
+	trace_line("end shared_timer_test");
+}
+
+template <typename Tick>
+void tick_bench(const char* name, Tick&& tick)
+{
+	const int N = 10000000;
+	long long sum = 0;
+	long long tk = get_tick_ns();
+	for (int i = 0; i < N; i++)
+	{
+		sum += (long long)tick();
+	}
+	tk = get_tick_ns() - tk;
+	trace_line(name, " ", (double)tk / N, "ns/call (", sum & 1, ")");
+}
+
+void tick_bench_test()
+{
+	//ENABLE_FAST_TICK¼ʱ״ζʱӺFAST_TICK_CALIBRATE_MS(Ĭ10ms)ſԤȵȴУ׼ټʱ
+	const long long warmBegin = get_tick_ms();
+	while (0 == strcmp("clock_gettime", get_tick_source()) && get_tick_ms() - warmBegin < 100) {}
+	trace_line("begin tick_bench_test, tick source ", get_tick_source());
+#ifdef __linux__
+	tick_bench("clock_gettime", []
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+	});
+#endif
+	tick_bench("get_tick_ns", [] { return get_tick_ns(); });
+	tick_bench("get_tick_us", [] { return get_tick_us(); });
+	tick_bench("get_tick_ms", [] { return get_tick_ms(); });
+	tick_bench("cpu_tick", [] { return cpu_tick(); });
+	tick_bench("steady_clock", [] { return std::chrono::steady_clock::now().time_since_epoch().count(); });
+	io_engine ios;
+	ios.run();
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [](my_actor* self)
+	{
+		//strandENABLE_LOOP_TICKֵֻ
+		tick_bench("loopTickUs", [] { return io_engine::loopTickUs(); });
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	trace_line("end tick_bench_test");
+}
+
 void create_child_test()
 {
 	trace_line("begin create_child_test");
@@ -892,6 +1062,263 @@ void create_child_test()
 	trace_line("end create_child_test");
 }
 
+void actor_churn_test()
+{
+	trace_line("begin actor_churn_test");
+	io_engine ios;
+	ios.run(run_thread::cpu_thread_number());
+	const int num = 100000;
+	std::atomic<int> count(0);
+	long long beginTick = get_tick_us();
+	for (size_t i = 0; i < ios.ioThreads(); i++)
+	{
+		go(ios)[&](my_actor* self)
+		{
+			//actor˳contextڱ̻߳з
+			for (int j = 0; j < num; j++)
+			{
+				child_handle child = self->create_child([&](my_actor* self)
+				{
+					count++;
+				});
+				self->child_run(child);
+				self->child_wait_quit(child);
+			}
+		};
+	}
+	ios.stop();
+	long long time = get_tick_us() - beginTick;
+	trace_line("actors ", (int)count, ", ", (long long)count * 1000000 / (time ? time : 1), " per second");
+	ContextPool_::pool_stats stats = my_actor::stack_pool_stats();
+	trace_line("stacks ", stats.stackCount, ", total ", stats.stackTotalSize / 1024, "k, idle ", stats.idleCount, ", decommitted ", stats.decommitCount, ", pressure ", stats.pressure);
+	trace_line("trim ", my_actor::trim_stack_pool() / 1024, "k");
+	trace_line("end actor_churn_test");
+}
+
+void hot_stack_test()
+{
+	trace_line("begin hot_stack_test");
+	io_engine ios;
+	ios.run();
+	go(ios, 256 kB, stack_prefault | stack_lock | stack_no_decommit)[&](my_actor* self)
+	{
+		//ջԤύݹ鲻ҳȱҳ
+		long long tk = get_tick_us();
+		child_handle child = self->create_child(auto_stack(128 kB, stack_prefault | stack_huge_page)[](my_actor* self)
+		{
+			self->sleep(10);
+		});
+		self->child_run(child);
+		self->child_wait_quit(child);
+		trace_line("child ", get_tick_us() - tk, "us");
+	};
+	ios.stop();
+	ContextPool_::pool_stats stats = my_actor::stack_pool_stats();
+	trace_line("stacks ", stats.stackCount, ", idle ", stats.idleCount, ", decommitted ", stats.decommitCount);
+	trace_line("end hot_stack_test");
+}
+
+void stack_sampling_test()
+{
+	trace_line("begin stack_sampling_test");
+	io_engine ios;
+	ios.run();
+	my_actor::set_stack_sampling(true);
+	go(ios)[&](my_actor* self)
+	{
+		std::list<child_handle> childList;
+		for (int i = 0; i < 100; i++)
+		{
+			childList.push_back(self->create_child([i](my_actor* self)
+			{
+				char buff[16 kB];
+				memset(buff, i, sizeof(buff));
+				self->sleep(100);
+			}));
+			childList.push_back(self->create_child([](my_actor* self)
+			{
+				self->sleep(100);
+			}, 32 kB));
+		}
+		self->children_run(childList);
+		self->sleep(10);
+		//мʱɨ裬˳ʱļ
+		for (auto& ele : my_actor::scan_stack_sites())
+		{
+			trace_line(ele.site, " count ", ele.count, ", p50 ", ele.p50 / 1024, "k, p99 ", ele.p99 / 1024, "k, max ", ele.max / 1024,
+				"k, stack ", ele.stackSize / 1024, "k, unused ", ele.unused / 1024, "k");
+		}
+		self->children_wait_quit(childList);
+	};
+	ios.stop();
+	my_actor::set_stack_sampling(false);
+	trace_line("end stack_sampling_test");
+}
+
+int deep_recursion(my_actor* self, int depth)
+{
+	char buff[1 kB];
+	memset(buff, depth, sizeof(buff));
+	if (0 == depth % 64)
+	{
+		self->yield();
+	}
+	return depth ? buff[depth % sizeof(buff)] + deep_recursion(self, depth - 1) : 0;
+}
+
+void deep_stack_test()
+{
+	trace_line("begin deep_stack_test");
+	io_engine ios;
+	ios.run(run_thread::cpu_thread_number());
+	go(ios)[&](my_actor* self)
+	{
+		std::list<child_handle> childList;
+		for (int i = 0; i < 32; i++)
+		{
+			//СջActorðȫջִݹ飬ڼл
+			childList.push_back(self->create_child([](my_actor* self)
+			{
+				for (int j = 0; j < 10; j++)
+				{
+					const int res = self->run_in_deep_stack([self]{return deep_recursion(self, 256); });
+					self->run_in_safe_stack([&]{return res + 1; });
+					self->run_in_thread_stack([&]{return res + 1; });
+				}
+				try
+				{
+					self->run_in_deep_stack([]{throw std::runtime_error("deep"); });
+				}
+				catch (std::runtime_error&) {}
+			}, 16 kB));
+		}
+		self->children_run(childList);
+		self->children_wait_quit(childList);
+	};
+	ios.stop();
+	safe_stack_stats stats = ios.safeStackStats();
+	trace_line("safe ", stats.safeCount, "/", stats.safeTime, "us, deep ", stats.deepCount, "/", stats.deepTime, "us, thread ", stats.threadCount, "/", stats.threadTime,
+		"us, max block ", stats.maxBlockTime, "us, stacks ", stats.stackCount);
+	trace_line("end deep_stack_test");
+}
+
+long long resident_kb()
+{
+#ifdef __linux__
+	long long size = 0;
+	long long resident = 0;
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (file)
+	{
+		if (2 != fscanf(file, "%lld %lld", &size, &resident))
+		{
+			resident = 0;
+		}
+		fclose(file);
+	}
+	return resident * (MEM_PAGE_SIZE / 1024);
+#else
+	return 0;
+#endif
+}
+
+void spill_stack_test()
+{
+	trace_line("begin spill_stack_test");
+	io_engine ios;
+	ios.run(run_thread::cpu_thread_number());
+	go(ios)[](my_actor* self)
+	{
+		const int num = 10000;
+		const int waitNum = 10;
+		for (int spill = 0; spill < 2; spill++)
+		{
+			//Actorwait_msgϣģʽÿActorгֻڶϱõջ֡
+			//ԱȫʱפڴÿλѵĿ(رսÿεȴ)
+			msg_handle<> readyHandle;
+			msg_notifer<> readyNtf = self->make_msg_notifer_to_self(readyHandle);
+			std::vector<msg_notifer<int>> ntfs(num);
+			std::list<child_handle> children;
+			const long long beginRss = resident_kb();
+			for (int i = 0; i < num; i++)
+			{
+				auto h = [&, i](my_actor* self)
+				{
+					msg_handle<int> amh;
+					ntfs[i] = self->make_msg_notifer_to_self(amh);
+					readyNtf();
+					for (int j = 0; j < waitNum; j++)
+					{
+						self->wait_msg(amh);
+					}
+				};
+				children.push_back(spill ? self->create_spill_child(h, 0) : self->create_child(h, SPILL_STACK_SIZE));
+			}
+			self->children_run(children);
+			for (int i = 0; i < num; i++)
+			{
+				self->wait_msg(readyHandle);
+			}
+			const long long idleRss = resident_kb();
+			long long beginTick = get_tick_us();
+			for (int j = 0; j < waitNum; j++)
+			{
+				for (int i = 0; i < num; i++)
+				{
+					ntfs[i](j);
+				}
+			}
+			self->children_wait_quit(children);
+			long long time = get_tick_us() - beginTick;
+			trace_line(spill ? "spill stack" : "dedicated stack", " actors ", num, ", idle rss +", idleRss - beginRss, " kB, ",
+				(double)time * 1000 / ((long long)num * waitNum), " ns per wakeup");
+		}
+		//лջActor֮价δϢٻഥշȴʱջ֡ѻͶǰҪȿ
+		const int ringNum = 100;
+		const int roundNum = 100;
+		int errors = 0;
+		msg_handle<> readyHandle;
+		msg_notifer<> readyNtf = self->make_msg_notifer_to_self(readyHandle);
+		std::vector<msg_notifer<std::string, int>> ringNtfs(ringNum);
+		std::vector<trig_notifer<std::string>> trigNtfs(ringNum);
+		std::list<child_handle> ring;
+		for (int i = 0; i < ringNum; i++)
+		{
+			ring.push_back(self->create_spill_child([&, i](my_actor* self)
+			{
+				msg_handle<std::string, int> amh;
+				trig_handle<std::string> ath;
+				ringNtfs[i] = self->make_msg_notifer_to_self(amh);
+				trigNtfs[i] = self->make_trig_notifer_to_self(ath);
+				readyNtf();
+				for (int j = 0; j < roundNum; j++)
+				{
+					std::string str;
+					int n = 0;
+					self->wait_msg(amh, str, n);
+					errors += str != "ring" + std::to_string(n);
+					if (n + 1 < ringNum * roundNum)
+					{
+						ringNtfs[(i + 1) % ringNum]("ring" + std::to_string(n + 1), n + 1);
+					}
+				}
+				trigNtfs[(i + 1) % ringNum]("trig" + std::to_string(i));
+				errors += self->wait_trig(ath) != "trig" + std::to_string((i + ringNum - 1) % ringNum);
+			}));
+		}
+		self->children_run(ring);
+		for (int i = 0; i < ringNum; i++)
+		{
+			self->wait_msg(readyHandle);
+		}
+		ringNtfs[0]("ring0", 0);
+		self->children_wait_quit(ring);
+		trace_line("spill stack ring ", ringNum, "x", roundNum, ", errors ", errors);
+	};
+	ios.stop();
+	trace_line("end spill_stack_test");
+}
+
 void suspend_test()
 {
 	trace_line("begin suspend_test");
@@ -960,18 +1387,50 @@ void auto_stack_test()
 		ah->run();
 		ah->outside_wait_quit();
 		trace_line("stack size:", ah->stack_size(), ", using size:", ah->using_stack_size());
+		if (0 == i)
+		{
+			//ѧջ´״δʹøóߴ磬ʱĿ¼ɾ
+			const char* tmpDir = getenv("TEMP");
+			tmpDir = tmpDir ? tmpDir : getenv("TMPDIR");
+			const std::string profile = std::string(tmpDir ? tmpDir : "/tmp") + "/auto_stack.profile";
+			my_actor::export_stack_profile(profile.c_str());
+			my_actor::import_stack_profile(profile.c_str());
+			std::remove(profile.c_str());
+		}
 	}
 	ios.stop();
 	trace_line("end auto_stack_test");
 }
 
-void co_perfor_test()
+void co_perfor_test(io_engine::engine_mode mode, bool pinned = false, bool numa = false)
 {
-	trace_line("begin co_perfor_test");
-	io_engine ios;
-	ios.run(run_thread::cpu_thread_number());
+	trace_line("begin co_perfor_test ", engine_mode_name(mode), pinned ? " pinned" : "", numa ? " numa" : "");
+	io_engine ios(true, "co_perfor_test", mode);
+	if (numa)
+	{
+		ios.runNuma();
+	}
+	else
+	{
+		ios.run(run_thread::cpu_thread_number());
+	}
 	std::vector<size_t> count(ios.ioThreads());
-	std::vector<shared_strand> strands = boost_strand::create_multi(ios.ioThreads(), ios);
+	std::vector<shared_strand> strands(ios.ioThreads());
+	for (size_t i = 0; i < ios.ioThreads(); i++)
+	{
+		if (pinned)
+		{
+			strands[i] = boost_strand::create_pinned(ios, i);
+		}
+		else if (numa)
+		{
+			strands[i] = boost_strand::create(ios, ios.threadNode(i));
+		}
+		else
+		{
+			strands[i] = boost_strand::create(ios);
+		}
+	}
 	std::list<generator_handle> gens;
 	size_t num = 1000;
 	for (size_t i = 0; i < ios.ioThreads(); i++)
@@ -1008,7 +1467,212 @@ void co_perfor_test()
 	}
 	trace_line("generator number=", ios.ioThreads()*num, ", ", "switching frequency=", (int)f);
 	ios.stop();
-	trace_line("end co_perfor_test");
+	trace_line("end co_perfor_test ", engine_mode_name(mode), pinned ? " pinned" : "", numa ? " numa" : "");
+}
+
+const char* idle_mode_name(idle_policy::idle_mode mode)
+{
+	switch (mode)
+	{
+	case idle_policy::spin: return "spin";
+	case idle_policy::adaptive: return "adaptive";
+	default: return "park";
+	}
+}
+
+void ping_pong_test(io_engine::engine_mode mode, idle_policy::idle_mode idleMode)
+{
+	trace_line("begin ping_pong_test ", engine_mode_name(mode), " ", idle_mode_name(idleMode));
+	io_engine ios(true, "ping_pong_test", mode);
+	ios.idlePolicy(idle_policy(idleMode));
+	ios.run(2);
+	const int pingNum = 100000;
+	std::shared_ptr<co_channel<int>> pingChan = std::make_shared<co_channel<int>>(boost_strand::create(ios), 1);
+	std::shared_ptr<co_channel<int>> pongChan = std::make_shared<co_channel<int>>(boost_strand::create(ios), 1);
+	long long beginTick = get_tick_us();
+	co_go(pongChan->self_strand())[&](co_generator)
+	{
+		co_begin_context;
+		int i;
+		int res;
+		co_use_state;
+		co_end_context(ctx);
+
+		co_begin;
+		for (ctx.i = 0; ctx.i < pingNum; ctx.i++)
+		{
+			co_chan_io(*pingChan) << ctx.i;
+			co_chan_io(*pongChan) >> ctx.res;
+		}
+		co_end;
+	};
+	co_go(pingChan->self_strand())[&](co_generator)
+	{
+		co_begin_context;
+		int i;
+		int res;
+		co_use_state;
+		co_end_context(ctx);
+
+		co_begin;
+		for (ctx.i = 0; ctx.i < pingNum; ctx.i++)
+		{
+			co_chan_io(*pingChan) >> ctx.res;
+			co_chan_io(*pongChan) << ctx.res;
+		}
+		co_end;
+	};
+	ios.stop();
+	long long time = get_tick_us() - beginTick;
+	idle_stats stats = ios.idleStats();
+	trace_line("round trip ", (double)time / pingNum, "us, spin hits ", stats.spinHits, ", spin misses ", stats.spinMisses);
+	trace_line("end ping_pong_test ", engine_mode_name(mode), " ", idle_mode_name(idleMode));
+}
+
+void actor_ping_pong_test(io_engine::engine_mode mode, idle_policy::idle_mode idleMode)
+{
+	trace_line("begin actor_ping_pong_test ", engine_mode_name(mode), " ", idle_mode_name(idleMode));
+	io_engine ios(true, "actor_ping_pong_test", mode);
+	ios.idlePolicy(idle_policy(idleMode));
+	ios.run(2);
+	const int pingNum = 100000;
+	long long time = 0;
+	actor_handle ah = my_actor::create(boost_strand::create(ios), [&](my_actor* self)
+	{
+		msg_handle<int> pingHandle;
+		msg_handle<int> pongHandle;
+		auto pongNtf = self->make_msg_notifer_to_self(pongHandle);
+		//actorڲͬstrandÿϢҪѶԷ
+		child_handle ch = self->create_child(boost_strand::create(ios), [&](my_actor* self)
+		{
+			for (int i = 0; i < pingNum; i++)
+			{
+				pongNtf(self->wait_msg(pingHandle));
+			}
+		});
+		auto pingNtf = self->make_msg_notifer_to(ch, pingHandle);
+		self->child_run(ch);
+		long long tk = get_tick_us();
+		for (int i = 0; i < pingNum; i++)
+		{
+			pingNtf(i);
+			self->wait_msg(pongHandle);
+		}
+		time = get_tick_us() - tk;
+		self->child_wait_quit(ch);
+	});
+	ah->run();
+	ah->outside_wait_quit();
+	ios.stop();
+	idle_stats stats = ios.idleStats();
+	trace_line("round trip ", (double)time / pingNum, "us, spin hits ", stats.spinHits, ", spin misses ", stats.spinMisses);
+	trace_line("end actor_ping_pong_test ", engine_mode_name(mode), " ", idle_mode_name(idleMode));
+}
+
+void co_class_test(io_engine::engine_mode mode)
+{
+	trace_line("begin co_class_test ", engine_mode_name(mode));
+	io_engine ios(true, "co_class_test", mode);
+	ios.run(run_thread::cpu_thread_number());
+	const strand_class classes[strand_class_num] = { strand_realtime, strand_normal, strand_background };
+	const size_t num = 4 * ios.ioThreads();
+	std::vector<size_t> count(strand_class_num * num);
+	std::list<generator_handle> gens;
+	for (int i = 0; i < strand_class_num; i++)
+	{
+		for (size_t j = 0; j < num; j++)
+		{
+			generator_handle gen = co_go(boost_strand::create_class(ios, classes[i]))[&count, i, j, num](co_generator)
+			{
+				co_no_context;
+
+				co_begin;
+				while (true)
+				{
+					++count[i * num + j];
+					co_io_tick;
+				}
+				co_end;
+			};
+			gens.push_back(gen);
+		}
+	}
+	run_thread::sleep(1000);
+	size_t depth[strand_class_num];
+	for (int i = 0; i < strand_class_num; i++)
+	{
+		depth[i] = ios.classQueueDepth(classes[i]);
+	}
+	while (!gens.empty())
+	{
+		gens.front()->stop();
+		gens.pop_front();
+	}
+	size_t ct[strand_class_num] = { 0 };
+	for (size_t i = 0; i < count.size(); i++)
+	{
+		ct[i / num] += count[i];
+	}
+	trace_line("realtime=", ct[0], ", normal=", ct[1], ", background=", ct[2]);
+	trace_line("queue depth realtime=", depth[0], ", normal=", depth[1], ", background=", depth[2]);
+#ifdef ENABLE_STRAND_STATS
+	strand_stats stats = ios.strandStats(true);
+	trace_line("queue wait p50=", stats.queueWait.percentile(50), "ns, p99=", stats.queueWait.percentile(99), "ns, max=", stats.queueWait.max, "ns");
+	trace_line("run time p50=", stats.runTime.percentile(50), "ns, p99=", stats.runTime.percentile(99), "ns, round ticks mean=", stats.roundTicks.mean());
+#endif
+	ios.stop();
+	trace_line("end co_class_test ", engine_mode_name(mode));
+}
+
+void resize_test(io_engine::engine_mode mode)
+{
+	trace_line("begin resize_test ", engine_mode_name(mode));
+	io_engine ios(true, "resize_test", mode);
+	ios.run(1);
+	const size_t num = 2 * run_thread::cpu_thread_number();
+	std::vector<size_t> count(num);
+	std::list<generator_handle> gens;
+	for (size_t i = 0; i < num; i++)
+	{
+		//һstrand󶨵0̣߳߳ʱӰ
+		shared_strand strand = i & 1 ? boost_strand::create(ios) : boost_strand::create_pinned(ios, 0);
+		gens.push_back(co_go(strand)[&count, i](co_generator)
+		{
+			co_no_context;
+
+			co_begin;
+			while (true)
+			{
+				++count[i];
+				co_io_tick;
+			}
+			co_end;
+		});
+	}
+	auto sumCount = [&count]()->size_t
+	{
+		size_t sum = 0;
+		for (size_t ele : count)
+		{
+			sum += ele;
+		}
+		return sum;
+	};
+	const size_t sizes[] = { run_thread::cpu_thread_number(), 1, 3, 2 };
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+	{
+		const size_t total = sumCount();
+		const bool ok = ios.resize(sizes[i]);
+		run_thread::sleep(200);
+		trace_line("resize ", sizes[i], (ok ? " ok" : " refused"), ", threads=", ios.ioThreads(), ", ids=", ios.threadsID().size(), ", ticks=", sumCount() - total);
+	}
+	while (!gens.empty())
+	{
+		gens.front()->stop();
+		gens.pop_front();
+	}
+	ios.stop();
+	trace_line("end resize_test ", engine_mode_name(mode));
 }
 
 void co_convar_test()
@@ -1478,9 +2142,48 @@ int main(int argc, char *argv[])
 	trace("\n");
 	co_convar_test();
 	trace("\n");
+	resize_test(io_engine::asio_strand);
+	trace("\n");
+	resize_test(io_engine::work_steal);
+	trace("\n");
+	resize_test(io_engine::sharded);
+	trace("\n");
 #ifdef NDEBUG
-	co_perfor_test();
+	co_perfor_test(io_engine::asio_strand);
+	trace("\n");
+	co_perfor_test(io_engine::work_steal);
+	trace("\n");
+	co_perfor_test(io_engine::work_steal, true);
+	trace("\n");
+	co_perfor_test(io_engine::work_steal, false, true);
 	trace("\n");
+	co_perfor_test(io_engine::sharded);
+	trace("\n");
+	co_perfor_test(io_engine::sharded, false, true);
+	trace("\n");
+	co_class_test(io_engine::asio_strand);
+	trace("\n");
+	co_class_test(io_engine::work_steal);
+	trace("\n");
+	actor_churn_test();
+	spill_stack_test();
+	trace("\n");
+	hot_stack_test();
+	trace("\n");
+	stack_sampling_test();
+	deep_stack_test();
+	trace("\n");
+	for (int i = idle_policy::park; i <= idle_policy::adaptive; i++)
+	{
+		ping_pong_test(io_engine::asio_strand, (idle_policy::idle_mode)i);
+		trace("\n");
+		ping_pong_test(io_engine::work_steal, (idle_policy::idle_mode)i);
+		trace("\n");
+		ping_pong_test(io_engine::sharded, (idle_policy::idle_mode)i);
+		trace("\n");
+		actor_ping_pong_test(io_engine::work_steal, (idle_policy::idle_mode)i);
+		trace("\n");
+	}
 #endif
 	auto_stack_test();
 	trace("\n");
@@ -1489,6 +2192,10 @@ int main(int argc, char *argv[])
 	create_child_test();
 	trace("\n");
 	async_timer_test();
+	timer_cancel_test();
+	timer_slack_test();
+	shared_timer_test();
+	tick_bench_test();
 	trace("\n");
 	trig_test();
 	trace("\n");
@@ -1514,7 +2221,9 @@ int main(int argc, char *argv[])
 	trace("\n");
 	wait_multi_msg();
 	trace("\n");
-// 	perfor_test();
+// 	perfor_test(io_engine::asio_strand);
+// 	trace("\n");
+// 	perfor_test(io_engine::work_steal);
 // 	trace("\n");
 	trace_line("end");
 	getchar();
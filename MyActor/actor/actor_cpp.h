@@ -9,11 +9,16 @@ ENABLE_UV_ACTOR 
 ENABLE_NEXT_TICK next_tick
 ENABLE_CHECK_LOST ֪ͨʧ
 ENABLE_DUMP_STACK ջ
+ENABLE_GROWABLE_STACK linuxactorջ(Խʱչ1Mio_engine߳)
 PRINT_ACTOR_STACK actorջӡ־
 DISABLE_AUTO_STACK ջռԶ
 DISABLE_HIGH_TIMER high_resolution_timerʱdeadline_timerʱ
 DISABLE_BOOST_TIMER boostʱwaitable_timerʱ
 ENABLE_GLOBAL_TIMER ȫֶʱ(DISABLE_BOOST_TIMERʹ)
+ENABLE_SHARED_TIMER ùʱͬһio_service(Ƭ)ϵstrandasioʱstrandʱԸά޶(δDISABLE_BOOST_TIMERʱʹ)
+ENABLE_TIMER_WHEEL ÷ֲʱֹstrandڵĶʱ
+ENABLE_FAST_TICK linuxget_tick_*CPU(x86-64TSC/ARM64 cntvct)ʱʱ˵clock_gettime
+ENABLE_LOOP_TICK strandλʱ䣬ʱȡοʼʱ(ڳʱִкʱǰ)
 ENABLE_TLS_CHECK_SELF TLS⵱ǰĸActor
 ENABLE_ASIO_HANDLER_ALLOCATE_EX asio handlerչ
 ENABLE_ASIO_PRE_OP tcp/udpasync_ioʱȳԷioʧܺͶ첽
@@ -29,15 +34,18 @@ ENABLE_ASIO_PRE_OP 
 #include "context_pool.cpp"
 #include "context_yield.cpp"
 #include "generator.cpp"
+#include "idle_spin.cpp"
 #include "io_engine.cpp"
 #include "my_actor.cpp"
 #include "qt_strand.cpp"
 #include "run_thread.cpp"
 #include "scattered.cpp"
 #include "shared_strand.cpp"
+#include "shared_timer.cpp"
+#include "steal_scheduler.cpp"
 #include "strand_ex.cpp"
+#include "strand_stats.cpp"
 #include "trace_stack.cpp"
 #include "uv_strand.cpp"
 #include "waitable_timer.cpp"
-
 #endif
\ No newline at end of file
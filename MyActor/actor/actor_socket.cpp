@@ -1,6 +1,43 @@
 #include "actor_socket.h"
+#ifdef __linux__
+#include <unistd.h>
+
+//һעᵽĿio_servicereactorϣٹرԭ
+template <typename Socket>
+static boost::system::error_code migrate_socket(Socket& sck, boost::asio::io_service& ios)
+{
+	boost::system::error_code ec;
+	const typename Socket::endpoint_type ep = sck.local_endpoint(ec);
+	if (ec)
+	{
+		return ec;
+	}
+	const int fd = ::dup(sck.native_handle());
+	if (-1 == fd)
+	{
+		return boost::system::error_code(errno, boost::asio::error::get_system_category());
+	}
+	Socket newSck(ios);
+	newSck.assign(ep.protocol(), fd, ec);
+	if (ec)
+	{
+		::close(fd);
+		return ec;
+	}
+	boost::system::error_code closeEc;
+	sck.close(closeEc);
+	sck = std::move(newSck);
+	return ec;
+}
+#endif
 
 tcp_socket::tcp_socket(io_engine& ios)
+:tcp_socket((boost::asio::io_service&)ios) {}
+
+tcp_socket::tcp_socket(const shared_strand& strand)
+:tcp_socket(strand->get_io_service()) {}
+
+tcp_socket::tcp_socket(boost::asio::io_service& ios)
 :_socket(ios), _holdRead(false), _holdWrite(false), _cancelRead(false), _cancelWrite(false), _nonBlocking(false)
 #ifdef ENABLE_ASIO_PRE_OP
 , _preOption(false)
@@ -64,6 +101,34 @@ void tcp_socket::swap(tcp_socket& other)
 #endif
 }
 
+tcp_socket::result tcp_socket::migrate(const shared_strand& strand)
+{
+	boost::asio::io_service& ios = strand->get_io_service();
+	if (&_socket.get_io_service() == &ios)
+	{
+		return result{ 0, 0, true };
+	}
+	if (!_socket.is_open())
+	{
+		_socket = boost::asio::ip::tcp::socket(ios);
+		return result{ 0, 0, true };
+	}
+#ifdef __linux__
+#if (_DEBUG || DEBUG)
+	assert(!_reading && !_writing);
+#endif
+	boost::system::error_code ec = migrate_socket(_socket, ios);
+	if (!ec && _nonBlocking)
+	{
+		set_internal_non_blocking();
+	}
+	return result{ 0, ec.value(), !ec };
+#else
+	//iocpsocketֻܹһɶ˿
+	return result{ 0, boost::asio::error::operation_not_supported, false };
+#endif
+}
+
 tcp_socket::result tcp_socket::assign(boost::asio::detail::socket_type sckFd)
 {
 	boost::system::error_code ec;
@@ -820,7 +885,14 @@ bool tcp_socket::init_send_file(HANDLE hFile, unsigned long long* offset, size_t
 //////////////////////////////////////////////////////////////////////////
 
 tcp_acceptor::tcp_acceptor(io_engine& ios)
-:_ios(&ios), _nonBlocking(false)
+:_ios(&(boost::asio::io_service&)ios), _nonBlocking(false)
+#ifdef ENABLE_ASIO_PRE_OP
+, _preOption(false)
+#endif
+{}
+
+tcp_acceptor::tcp_acceptor(const shared_strand& strand)
+:_ios(&strand->get_io_service()), _nonBlocking(false)
 #ifdef ENABLE_ASIO_PRE_OP
 , _preOption(false)
 #endif
@@ -1099,6 +1171,12 @@ void tcp_acceptor::set_internal_non_blocking()
 //////////////////////////////////////////////////////////////////////////
 
 udp_socket::udp_socket(io_engine& ios)
+:udp_socket((boost::asio::io_service&)ios) {}
+
+udp_socket::udp_socket(const shared_strand& strand)
+:udp_socket(strand->get_io_service()) {}
+
+udp_socket::udp_socket(boost::asio::io_service& ios)
 :_socket(ios), _nonBlocking(false)
 #ifndef HAS_ASIO_CANCEL_IO
 , _holdRecv(false), _holdSend(false), _cancelRecv(false), _cancelSend(false)
@@ -1289,6 +1367,31 @@ void udp_socket::swap(udp_socket& other)
 #endif
 }
 
+udp_socket::result udp_socket::migrate(const shared_strand& strand)
+{
+	boost::asio::io_service& ios = strand->get_io_service();
+	if (&_socket.get_io_service() == &ios)
+	{
+		return result{ 0, 0, true };
+	}
+	if (!_socket.is_open())
+	{
+		_socket = boost::asio::ip::udp::socket(ios);
+		return result{ 0, 0, true };
+	}
+#ifdef __linux__
+	boost::system::error_code ec = migrate_socket(_socket, ios);
+	if (!ec && _nonBlocking)
+	{
+		set_internal_non_blocking();
+	}
+	return result{ 0, ec.value(), !ec };
+#else
+	//iocpsocketֻܹһɶ˿
+	return result{ 0, boost::asio::error::operation_not_supported, false };
+#endif
+}
+
 void udp_socket::pre_option()
 {
 #ifdef ENABLE_ASIO_PRE_OP
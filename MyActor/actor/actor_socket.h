@@ -295,6 +295,11 @@ private:
 
 public:
 	tcp_socket(io_engine& ios);
+
+	/*!
+	@brief עᵽstrandڷƬreactor(shardedģʽЧģʽͬtcp_socket(io_engine))
+	*/
+	tcp_socket(const shared_strand& strand);
 	~tcp_socket();
 public:
 	/*!
@@ -409,6 +414,11 @@ public:
 	*/
 	void swap(tcp_socket& other);
 
+	/*!
+	@brief ǨƵstrandڷƬreactorϣֻûне첽ʱ(linuxЧ)
+	*/
+	result migrate(const shared_strand& strand);
+
 	/*!
 	@brief ԭʼ
 	*/
@@ -1099,6 +1109,7 @@ private:
 	result _try_mwrite_same(const void* const* buffs, const size_t* lengths, size_t count);
 	result _try_mread_same(void* const* buffs, const size_t* lengths, size_t count);
 	void set_internal_non_blocking();
+	tcp_socket(boost::asio::io_service& ios);
 private:
 	boost::asio::ip::tcp::socket _socket;
 #ifdef HAS_ASIO_SEND_FILE
@@ -1128,6 +1139,11 @@ class tcp_acceptor
 {
 public:
 	tcp_acceptor(io_engine& ios);
+
+	/*!
+	@brief עᵽstrandڷƬreactor(shardedģʽЧģʽͬtcp_acceptor(io_engine))
+	*/
+	tcp_acceptor(const shared_strand& strand);
 	~tcp_acceptor();
 public:
 	/*!
@@ -1266,7 +1282,7 @@ private:
 	void set_internal_non_blocking();
 	tcp_socket::result try_accept(tcp_socket& socket);
 private:
-	io_engine* _ios;
+	boost::asio::io_service* _ios;
 	stack_obj<boost::asio::ip::tcp::acceptor> _acceptor;
 	bool _nonBlocking;
 #ifdef ENABLE_ASIO_PRE_OP
@@ -1284,6 +1300,11 @@ public:
 	typedef socket_result result;
 public:
 	udp_socket(io_engine& ios);
+
+	/*!
+	@brief עᵽstrandڷƬreactor(shardedģʽЧģʽͬudp_socket(io_engine))
+	*/
+	udp_socket(const shared_strand& strand);
 	~udp_socket();
 public:
 	/*!
@@ -1350,6 +1371,11 @@ public:
 	@brief 
 	*/
 	void swap(udp_socket& other);
+
+	/*!
+	@brief ǨƵstrandڷƬreactorϣֻûне첽ʱ(linuxЧ)
+	*/
+	result migrate(const shared_strand& strand);
 	
 	/*!
 	@brief ԭʼ
@@ -2014,6 +2040,7 @@ private:
 	}
 private:
 	void set_internal_non_blocking();
+	udp_socket(boost::asio::io_service& ios);
 private:
 	boost::asio::ip::udp::socket _socket;
 	boost::asio::ip::udp::endpoint _remoteSenderEndpoint;
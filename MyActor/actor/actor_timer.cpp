@@ -1,7 +1,7 @@
 #include "actor_timer.h"
 #include "scattered.h"
 #include "my_actor.h"
-#ifndef DISABLE_BOOST_TIMER
+#if !(defined DISABLE_BOOST_TIMER) && !(defined ENABLE_SHARED_TIMER)
 #ifdef DISABLE_HIGH_TIMER
 #include <boost/asio/deadline_timer.hpp>
 typedef boost::asio::deadline_timer timer_type;
@@ -12,10 +12,14 @@ typedef boost::posix_time::microseconds micseconds;
 typedef boost::asio::basic_waitable_timer<boost::chrono::high_resolution_clock> timer_type;
 typedef boost::chrono::microseconds micseconds;
 #endif
-#else
+#elif (defined DISABLE_BOOST_TIMER)
 #include "waitable_timer.h"
 typedef WaitableTimerEvent_ timer_type;
 typedef long long micseconds;
+#else
+#include "shared_timer.h"
+typedef SharedTimerEvent_ timer_type;
+typedef long long micseconds;
 #endif
 
 ActorTimer_::ActorTimer_(const shared_strand& strand)
@@ -23,9 +27,11 @@ ActorTimer_::ActorTimer_(const shared_strand& strand)
 _extMaxTick(0), _extFinishTime(-1), _handlerQueue(MEM_POOL_LENGTH)
 {
 #ifdef DISABLE_BOOST_TIMER
-	_timer = new timer_type(strand->get_io_engine(), this);
+	_timer = new timer_type(strand->get_io_engine(), strand.get(), this);
+#elif (defined ENABLE_SHARED_TIMER)
+	_timer = new timer_type(strand->get_io_engine(), strand->get_io_service(), this);
 #else
-	_timer = new timer_type(strand->get_io_engine());
+	_timer = new timer_type(strand->get_io_service());
 #endif
 }
 
@@ -35,20 +41,23 @@ ActorTimer_::~ActorTimer_()
 	delete (timer_type*)_timer;
 }
 
-ActorTimer_::timer_handle ActorTimer_::timeout(long long us, actor_face_handle&& host, bool deadline)
+ActorTimer_::timer_handle ActorTimer_::timeout(long long us, actor_face_handle&& host, bool deadline, long long slack)
 {
 	assert(_weakStrand.lock()->running_in_this_thread());
 	if (!_lockStrand)
 	{
 		_lockStrand = _weakStrand.lock();
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 		_lockIos.create(_lockStrand->get_io_engine());
 #endif
 	}
 	assert(_lockStrand->running_in_this_thread());
 	timer_handle timerHandle;
-	timerHandle._beginStamp = get_tick_us();
-	long long et = deadline ? us : (timerHandle._beginStamp + us);
+	timerHandle._beginStamp = io_engine::loopTickUs();
+	long long et = _lockStrand->slack_deadline(deadline ? us : (timerHandle._beginStamp + us), slack);
+#ifdef ENABLE_TIMER_WHEEL
+	timerHandle._queueNode = _handlerQueue.insert(et, std::move(host));
+#else
 	if (et >= _extMaxTick)
 	{
 		_extMaxTick = et;
@@ -58,6 +67,7 @@ ActorTimer_::timer_handle ActorTimer_::timeout(long long us, actor_face_handle&&
 	{
 		timerHandle._queueNode = _handlerQueue.insert(std::make_pair(et, std::move(host)));
 	}
+#endif
 	
 	if (!_looping)
 	{//ʱѾ˳ѭʱ
@@ -91,10 +101,19 @@ void ActorTimer_::cancel(timer_handle& th)
 			_extMaxTick = 0;
 			_looping = false;
 			_handlerQueue.erase(itNode);
+#ifdef ENABLE_TIMER_WHEEL
+			_handlerQueue.shrink();
+#endif
 			//ûжʱ˳ʱѭ
 			boost::system::error_code ec;
 			as_ptype<timer_type>(_timer)->cancel(ec);
 		}
+#ifdef ENABLE_TIMER_WHEEL
+		else
+		{
+			_handlerQueue.erase(itNode);
+		}
+#else
 		else if (itNode->first == _extMaxTick)
 		{
 			_handlerQueue.erase(itNode++);
@@ -111,13 +130,14 @@ void ActorTimer_::cancel(timer_handle& th)
 		{
 			_handlerQueue.erase(itNode);
 		}
+#endif
 	}
 }
 
 void ActorTimer_::timer_loop(long long abs, long long rel)
 {
 	int tc = ++_timerCount;
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 	as_ptype<timer_type>(_timer)->async_wait(micseconds(abs), micseconds(rel), tc);
 #else
 	boost::system::error_code ec;
@@ -133,11 +153,11 @@ void ActorTimer_::timer_loop(long long abs, long long rel)
 #endif
 }
 
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 void ActorTimer_::post_event(int tc)
 {
 	assert(_lockStrand);
-	_lockStrand->post([this, tc]
+	_lockStrand->post_batch([this, tc]
 	{
 		event_handler(tc);
 		if (!_lockStrand)
@@ -166,6 +186,16 @@ void ActorTimer_::event_handler(int tc)
 		_extFinishTime = 0;
 		while (!_handlerQueue.empty())
 		{
+#ifdef ENABLE_TIMER_WHEEL
+			long long ct = get_tick_us();
+			handler_queue::iterator iter = _handlerQueue.expire(ct);
+			if (!iter)
+			{//ʱûеڽڵ㣬ȵһ޻ϲ·ʱ
+				_extFinishTime = _handlerQueue.next_time();
+				timer_loop(_extFinishTime, _extFinishTime - ct);
+				return;
+			}
+#else
 			handler_queue::iterator iter = _handlerQueue.begin();
 			long long ct = get_tick_us();
 			if (iter->first > ct)
@@ -174,6 +204,7 @@ void ActorTimer_::event_handler(int tc)
 				timer_loop(_extFinishTime, _extFinishTime - ct);
 				return;
 			}
+#endif
 			else
 			{
 				iter->second->timeout_handler();
@@ -181,6 +212,9 @@ void ActorTimer_::event_handler(int tc)
 			}
 		}
 		_looping = false;
+#ifdef ENABLE_TIMER_WHEEL
+		_handlerQueue.shrink();
+#endif
 		_lockStrand.reset();
 	}
 	else if (tc == _timerCount - 1)
@@ -5,6 +5,7 @@
 #include "run_strand.h"
 #include "msg_queue.h"
 #include "stack_object.h"
+#include "timer_wheel.h"
 
 class boost_strand;
 class qt_strand;
@@ -17,12 +18,16 @@ class AsyncTimer_;
 @brief Actor ڲʹõĶʱ
 */
 class ActorTimer_
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 	: public TimerBoostCompletedEventFace_
 #endif
 {
 	typedef std::shared_ptr<ActorTimerFace_> actor_face_handle;
+#ifdef ENABLE_TIMER_WHEEL
+	typedef TimerWheel_<actor_face_handle> handler_queue;
+#else
 	typedef msg_multimap<long long, actor_face_handle> handler_queue;
+#endif
 
 	friend boost_strand;
 	friend qt_strand;
@@ -57,9 +62,10 @@ private:
 	@param us ΢
 	@param host ׼ʱActor
 	@param deadline ǷΪʱ
+	@param slack ϲݲ(΢)-1ʹstrand/ȫ
 	@return ʱcancel
 	*/
-	timer_handle timeout(long long us, actor_face_handle&& host, bool deadline = false);
+	timer_handle timeout(long long us, actor_face_handle&& host, bool deadline = false, long long slack = -1);
 
 	/*!
 	@brief ȡʱ
@@ -75,7 +81,7 @@ private:
 	@brief timer¼
 	*/
 	void event_handler(int tc);
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 	void post_event(int tc);
 	void cancel_event();
 #endif
@@ -86,7 +92,7 @@ private:
 	handler_queue _handlerQueue;
 	long long _extMaxTick;
 	long long _extFinishTime;
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 	stack_obj<io_work, false> _lockIos;
 #endif
 	int _timerCount;
@@ -2,7 +2,7 @@
 #include "scattered.h"
 #include "io_engine.h"
 #include "actor_timer.h"
-#ifndef DISABLE_BOOST_TIMER
+#if !(defined DISABLE_BOOST_TIMER) && !(defined ENABLE_SHARED_TIMER)
 #ifdef DISABLE_HIGH_TIMER
 #include <boost/asio/deadline_timer.hpp>
 typedef boost::asio::deadline_timer timer_type;
@@ -13,14 +13,18 @@ typedef boost::posix_time::microseconds micseconds;
 typedef boost::asio::basic_waitable_timer<boost::chrono::high_resolution_clock> timer_type;
 typedef boost::chrono::microseconds micseconds;
 #endif
-#else
+#elif (defined DISABLE_BOOST_TIMER)
 #include "waitable_timer.h"
 typedef WaitableTimerEvent_ timer_type;
 typedef long long micseconds;
+#else
+#include "shared_timer.h"
+typedef SharedTimerEvent_ timer_type;
+typedef long long micseconds;
 #endif
 
 AsyncTimer_::AsyncTimer_(ActorTimer_* actorTimer)
-:_actorTimer(actorTimer), _handler(NULL), _currTimeout(0), _isInterval(false) {}
+:_actorTimer(actorTimer), _handler(NULL), _currTimeout(0), _slack(-1), _isInterval(false) {}
 
 AsyncTimer_::~AsyncTimer_()
 {
@@ -83,12 +87,12 @@ bool AsyncTimer_::restart()
 		if (!_isInterval)
 		{
 			_actorTimer->cancel(_timerHandle);
-			_timerHandle = _actorTimer->timeout(_currTimeout, _weakThis.lock());
+			_timerHandle = _actorTimer->timeout(_currTimeout, _weakThis.lock(), false, _slack);
 		}
 		else if (!_handler->is_top_call())
 		{
 			_actorTimer->cancel(_timerHandle);
-			_timerHandle = _actorTimer->timeout(_currTimeout, _weakThis.lock());
+			_timerHandle = _actorTimer->timeout(_currTimeout, _weakThis.lock(), false, _slack);
 			_handler->set_deadtime(_timerHandle._beginStamp + _currTimeout);
 		}
 		return true;
@@ -102,6 +106,11 @@ bool AsyncTimer_::completed()
 	return !_handler;
 }
 
+void AsyncTimer_::slack(long long us)
+{
+	_slack = us;
+}
+
 shared_strand AsyncTimer_::self_strand()
 {
 	return _actorTimer->_weakStrand.lock();
@@ -136,7 +145,7 @@ long long AsyncTimer_::_utimeout(long long us, wrap_base* handler)
 	_isInterval = false;
 	_currTimeout = us;
 	_handler = handler;
-	_timerHandle = _actorTimer->timeout(us, _weakThis.lock());
+	_timerHandle = _actorTimer->timeout(us, _weakThis.lock(), false, _slack);
 	return _timerHandle._beginStamp;
 }
 
@@ -146,7 +155,7 @@ long long AsyncTimer_::_deadline(long long us, wrap_base* handler)
 	assert(!_handler);
 	_isInterval = false;
 	_handler = handler;
-	_timerHandle = _actorTimer->timeout(us, _weakThis.lock(), true);
+	_timerHandle = _actorTimer->timeout(us, _weakThis.lock(), true, _slack);
 	return _timerHandle._beginStamp;
 }
 
@@ -170,7 +179,7 @@ void AsyncTimer_::_uinterval(long long intervalus, wrap_base* handler, bool imme
 			{
 				long long& deadtime = thisHandler->deadtime_ref();
 				deadtime += intervalus;
-				_timerHandle = _actorTimer->timeout(deadtime, _weakThis.lock(), true);
+				_timerHandle = _actorTimer->timeout(deadtime, _weakThis.lock(), true, _slack);
 			}
 		}
 		else
@@ -185,7 +194,7 @@ void AsyncTimer_::_uinterval(long long intervalus, wrap_base* handler, bool imme
 	}
 	else
 	{
-		_timerHandle = _actorTimer->timeout(intervalus, _weakThis.lock());
+		_timerHandle = _actorTimer->timeout(intervalus, _weakThis.lock(), false, _slack);
 		_handler->set_deadtime(_timerHandle._beginStamp + intervalus);
 	}
 }
@@ -196,9 +205,11 @@ overlap_timer::overlap_timer(const shared_strand& strand)
 _extMaxTick(0), _extFinishTime(-1), _handlerQueue(MEM_POOL_LENGTH)
 {
 #ifdef DISABLE_BOOST_TIMER
-	_timer = new timer_type(strand->get_io_engine(), this);
+	_timer = new timer_type(strand->get_io_engine(), strand.get(), this);
+#elif (defined ENABLE_SHARED_TIMER)
+	_timer = new timer_type(strand->get_io_engine(), strand->get_io_service(), this);
 #else
-	_timer = new timer_type(strand->get_io_engine());
+	_timer = new timer_type(strand->get_io_service());
 #endif
 }
 
@@ -213,13 +224,16 @@ void overlap_timer::_timeout(long long us, timer_handle& timerHandle, bool deadl
 	if (!_lockStrand)
 	{
 		_lockStrand = _weakStrand.lock();
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 		_lockIos.create(_lockStrand->get_io_engine());
 #endif
 	}
 	assert(_lockStrand->running_in_this_thread());
-	timerHandle._timestamp = get_tick_us();
-	long long et = deadline ? us : (timerHandle._timestamp + us);
+	timerHandle._timestamp = io_engine::loopTickUs();
+	long long et = _lockStrand->slack_deadline(deadline ? us : (timerHandle._timestamp + us), timerHandle._slack);
+#ifdef ENABLE_TIMER_WHEEL
+	timerHandle._queueNode = _handlerQueue.insert(et, &timerHandle);
+#else
 	if (et >= _extMaxTick)
 	{
 		_extMaxTick = et;
@@ -229,6 +243,7 @@ void overlap_timer::_timeout(long long us, timer_handle& timerHandle, bool deadl
 	{
 		timerHandle._queueNode = _handlerQueue.insert(std::make_pair(et, &timerHandle));
 	}
+#endif
 
 	if (!_looping)
 	{//ʱѾ˳ѭʱ
@@ -259,10 +274,19 @@ void overlap_timer::_cancel(timer_handle& timerHandle)
 			_extMaxTick = 0;
 			_looping = false;
 			_handlerQueue.erase(itNode);
+#ifdef ENABLE_TIMER_WHEEL
+			_handlerQueue.shrink();
+#endif
 			//ûжʱ˳ʱѭ
 			boost::system::error_code ec;
 			as_ptype<timer_type>(_timer)->cancel(ec);
 		}
+#ifdef ENABLE_TIMER_WHEEL
+		else
+		{
+			_handlerQueue.erase(itNode);
+		}
+#else
 		else if (itNode->first == _extMaxTick)
 		{
 			_handlerQueue.erase(itNode++);
@@ -279,6 +303,7 @@ void overlap_timer::_cancel(timer_handle& timerHandle)
 		{
 			_handlerQueue.erase(itNode);
 		}
+#endif
 	}
 }
 
@@ -357,7 +382,7 @@ shared_strand overlap_timer::self_strand()
 void overlap_timer::timer_loop(long long abs, long long rel)
 {
 	int tc = ++_timerCount;
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 	as_ptype<timer_type>(_timer)->async_wait(micseconds(abs), micseconds(rel), tc);
 #else
 	boost::system::error_code ec;
@@ -373,11 +398,11 @@ void overlap_timer::timer_loop(long long abs, long long rel)
 #endif
 }
 
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 void overlap_timer::post_event(int tc)
 {
 	assert(_lockStrand);
-	_lockStrand->post([this, tc]
+	_lockStrand->post_batch([this, tc]
 	{
 		event_handler(tc);
 		if (!_lockStrand)
@@ -406,6 +431,16 @@ void overlap_timer::event_handler(int tc)
 		_extFinishTime = 0;
 		while (!_handlerQueue.empty())
 		{
+#ifdef ENABLE_TIMER_WHEEL
+			long long ct = get_tick_us();
+			handler_queue::iterator iter = _handlerQueue.expire(ct);
+			if (!iter)
+			{
+				_extFinishTime = _handlerQueue.next_time();
+				timer_loop(_extFinishTime, _extFinishTime - ct);
+				return;
+			}
+#else
 			handler_queue::iterator iter = _handlerQueue.begin();
 			long long ct = get_tick_us();
 			if (iter->first > ct)
@@ -414,6 +449,7 @@ void overlap_timer::event_handler(int tc)
 				timer_loop(_extFinishTime, _extFinishTime - ct);
 				return;
 			}
+#endif
 			else
 			{
 				timer_handle* const timerHandle = iter->second;
@@ -433,6 +469,9 @@ void overlap_timer::event_handler(int tc)
 			}
 		}
 		_looping = false;
+#ifdef ENABLE_TIMER_WHEEL
+		_handlerQueue.shrink();
+#endif
 		_lockStrand.reset();
 	}
 	else if (tc == _timerCount - 1)
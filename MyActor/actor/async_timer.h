@@ -6,6 +6,7 @@
 #include "msg_queue.h"
 #include "mem_pool.h"
 #include "stack_object.h"
+#include "timer_wheel.h"
 
 class ActorTimer_;
 class overlap_timer;
@@ -262,6 +263,11 @@ public:
 	*/
 	bool completed();
 
+	/*!
+	@brief ֮ʱĺϲݲ(΢)-1ʹstrand/ȫ
+	*/
+	void slack(long long us);
+
 	/*!
 	@brief 
 	*/
@@ -301,6 +307,7 @@ private:
 	ActorTimer_* _actorTimer;
 	wrap_base* _handler;
 	long long _currTimeout;
+	long long _slack;
 	reusable_mem _reuMem;
 	std::weak_ptr<AsyncTimer_> _weakThis;
 	ActorTimer_::timer_handle _timerHandle;
@@ -312,14 +319,18 @@ private:
 @brief صʹõĶʱ
 */
 class overlap_timer
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 	: public TimerBoostCompletedEventFace_
 #endif
 {
 public:
 	class timer_handle;
 private:
+#ifdef ENABLE_TIMER_WHEEL
+	typedef TimerWheel_<timer_handle*> handler_queue;
+#else
 	typedef msg_multimap<long long, timer_handle*> handler_queue;
+#endif
 
 	template <typename Handler>
 	struct wrap_timer_handler
@@ -368,7 +379,7 @@ public:
 		friend overlap_timer;
 	public:
 		timer_handle()
-			:_timestamp(0), _currTimeout(0), _handler(NULL), _isInterval(false) {}
+			:_timestamp(0), _currTimeout(0), _slack(-1), _handler(NULL), _isInterval(false) {}
 
 		~timer_handle()
 		{
@@ -384,6 +395,14 @@ public:
 		{
 			return !_handler;
 		}
+
+		/*!
+		@brief ֮ʱĺϲݲ(΢)-1ʹstrand/ȫ
+		*/
+		void slack(long long us)
+		{
+			_slack = us;
+		}
 	private:
 		void reset()
 		{
@@ -394,6 +413,7 @@ public:
 	private:
 		long long _timestamp;
 		long long _currTimeout;
+		long long _slack;
 		handler_queue::iterator _queueNode;
 		AsyncTimer_::wrap_base* _handler;
 		bool _isInterval;
@@ -499,7 +519,7 @@ public:
 private:
 	void timer_loop(long long abs, long long rel);
 	void event_handler(int tc);
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 	void post_event(int tc);
 	void cancel_event();
 #endif
@@ -517,7 +537,7 @@ private:
 	reusable_mem _reuMem;
 	long long _extMaxTick;
 	long long _extFinishTime;
-#ifdef DISABLE_BOOST_TIMER
+#ifdef TIMER_COMPLETED_EVENT
 	stack_obj<io_work, false> _lockIos;
 #endif
 	int _timerCount;
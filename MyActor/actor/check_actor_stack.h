@@ -100,6 +100,13 @@
 #define CHECK_PUMP_LOST_ALLOC_INDEX 7
 #define ASIO_HANDLER_ALLOC_EX_INDEX 8
 #define IO_ENGINE_INDEX 9
+#define STEAL_WORKER_INDEX 10
+#define STRAND_EX_RUN_INDEX 11
+#define NUMA_NODE_INDEX 12
+#define POST_BATCH_INDEX 13
+#define CONTEXT_CACHE_INDEX 14
+#define LOOP_TICK_INDEX 15
+#define STRAND_STATS_INDEX 16
 
 static_assert(0 < MEM_PAGE_SIZE && MEM_PAGE_SIZE % (4 kB) == 0, "");
 static_assert(0 < MEM_POOL_LENGTH && MEM_POOL_LENGTH < 10000000, "");
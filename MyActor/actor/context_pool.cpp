@@ -1,6 +1,13 @@
 #include "context_pool.h"
 #include "scattered.h"
 #include "my_actor.h"
+#include <fstream>
+#include <map>
+#include <typeindex>
+#include <algorithm>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
 #if (WIN32 && __GNUG__)
 #include <fibersapi.h>
 #endif
@@ -13,8 +20,154 @@
 #define CONTEXT_MIN_DELETE_CYCLE 300
 #endif
 
+//̼߳()
+#ifndef CONTEXT_CLEAN_TICK
+#define CONTEXT_CLEAN_TICK 1000
+#endif
+
+//ջĿ϶(ͻ֮)ʱж()黹ڴ
+#ifndef CONTEXT_MIN_TRIM_CYCLE
+#define CONTEXT_MIN_TRIM_CYCLE 2
+#endif
+
+//ֵÿ˥֮һ
+#ifndef CONTEXT_DEMAND_DECAY
+#define CONTEXT_DEMAND_DECAY 16
+#endif
+
+//ÿÿߴһദջ
+#ifndef CONTEXT_CLEAN_BATCH
+#define CONTEXT_CLEAN_BATCH 64
+#endif
+
+//ջַռԤ(ֽ)ʱտջ0
+#ifndef CONTEXT_STACK_BUDGET
+#define CONTEXT_STACK_BUDGET 0
+#endif
+
+//cgroupڴ(ҳ)ռ(ϵͳڴʹ)ﵽðٷֱΪڴѹ
+#ifndef CONTEXT_PRESSURE_PERCENT
+#define CONTEXT_PRESSURE_PERCENT 90
+#endif
+
+//cgroupڴPSIavg10ﵽðٷֱΪڴѹ
+#ifndef CONTEXT_PRESSURE_STALL
+#define CONTEXT_PRESSURE_STALL 10
+#endif
+
+//ջÿٸɨһеActorջ
+#ifndef STACK_SAMPLE_CYCLE
+#define STACK_SAMPLE_CYCLE 10
+#endif
+
 static_assert(1 < CONTEXT_MIN_CLEAN_CYCLE, "");
 static_assert(1 < CONTEXT_MIN_DELETE_CYCLE, "");
+static_assert(2 <= CONTEXT_CACHE_SIZE && CONTEXT_CACHE_SIZE <= 1024, "");
+static_assert(1 < CONTEXT_DEMAND_DECAY && 0 < CONTEXT_CLEAN_BATCH, "");
+static_assert(0 < STACK_SAMPLE_RESERVOIR && 0 < STACK_SAMPLE_CYCLE, "");
+
+#define CONTEXT_CACHE_BATCH (CONTEXT_CACHE_SIZE / 2)
+
+static std::string site_name(const std::type_info& site)
+{
+#ifdef __GNUG__
+	int status = 0;
+	char* const name = abi::__cxa_demangle(site.name(), NULL, NULL, &status);
+	if (name)
+	{
+		std::string res(name);
+		free(name);
+		return res;
+	}
+#endif
+	return site.name();
+}
+
+/*!
+@brief ջۻÿˮر̶λ
+*/
+struct StackProfile_
+{
+	struct site_samples
+	{
+		site_samples()
+		:_site(NULL), _count(0), _max(0), _stackSize(0), _unused(0) {}
+
+		const std::type_info* _site;
+		size_t _count;
+		size_t _max;
+		size_t _stackSize;
+		unsigned long long _unused;
+		std::vector<size_t> _samples;
+	};
+
+	StackProfile_()
+	:_seed(0) {}
+
+	void add(const std::type_info* site, size_t stackSize, size_t used)
+	{
+		site_samples& s = _sites[std::type_index(*site)];
+		s._site = site;
+		s._count++;
+		s._max = std::max(s._max, used);
+		s._stackSize = std::max(s._stackSize, stackSize);
+		s._unused += stackSize > used ? stackSize - used : 0;
+		if (s._samples.size() < STACK_SAMPLE_RESERVOIR)
+		{
+			s._samples.push_back(used);
+		}
+		else
+		{
+			_seed = _seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			const size_t j = (size_t)((_seed >> 33) % s._count);
+			if (j < STACK_SAMPLE_RESERVOIR)
+			{
+				s._samples[j] = used;
+			}
+		}
+	}
+
+	std::vector<ContextPool_::stack_site_stats> report() const
+	{
+		std::vector<ContextPool_::stack_site_stats> res;
+		res.reserve(_sites.size());
+		std::vector<size_t> sorted;
+		for (auto& ele : _sites)
+		{
+			const site_samples& s = ele.second;
+			sorted = s._samples;
+			std::sort(sorted.begin(), sorted.end());
+			ContextPool_::stack_site_stats stats;
+			stats.site = site_name(*s._site);
+			stats.count = s._count;
+			stats.p50 = sorted[(sorted.size() - 1) * 50 / 100];
+			stats.p99 = sorted[(sorted.size() - 1) * 99 / 100];
+			stats.max = s._max;
+			stats.stackSize = s._stackSize;
+			stats.unused = (size_t)(s._unused / s._count);
+			res.push_back(std::move(stats));
+		}
+		std::sort(res.begin(), res.end(), [](const ContextPool_::stack_site_stats& a, const ContextPool_::stack_site_stats& b)
+		{
+			return a.max > b.max;
+		});
+		return res;
+	}
+
+	std::map<std::type_index, site_samples> _sites;
+	unsigned long long _seed;
+};
+
+struct ContextPool_::spill_context
+{
+	char* _copy;//ʱջ֡
+	char* _copyLow;//ջ֡ջϵʼַNULLʾδ
+	size_t _copyCapacity;
+	size_t _swapCount;
+	size_t _promoteThreshold;
+	bool _idle;//Ϣȴгг󻻳ջ֡
+	bool _promoted;
+};
 
 void ContextPool_::coro_push_interface::yield()
 {
@@ -23,7 +176,16 @@ void ContextPool_::coro_push_interface::yield()
 
 void ContextPool_::coro_pull_interface::yield()
 {
+	if (_spill)
+	{
+		restore_stack(this);
+		_spill->_idle = false;
+	}
 	context_yield::pull_yield(_coroInfo);
+	if (_spill)
+	{
+		save_stack(this);
+	}
 }
 
 #if (WIN32 && (defined CHECK_SELF) && (_WIN32_WINNT >= 0x0502))
@@ -32,8 +194,30 @@ DWORD ContextPool_::coro_pull_interface::_actorFlsIndex = -1;
 
 //////////////////////////////////////////////////////////////////////////
 
-std::mutex* ContextPool_::context_pool_pck::_mutex = NULL;
-ContextPool_::context_pool_pck::pool_queue::shared_node_alloc* ContextPool_::context_pool_pck::_alloc = NULL;
+ContextPool_::context_node_pck::context_node_pck()
+:_alloc(MEM_POOL_LENGTH)
+{
+	_contextPool = (context_pool_pck*)malloc(sizeof(context_pool_pck)* 256);
+	for (int i = 0; i < 256; i++)
+	{
+		new(_contextPool + i)context_pool_pck(_mutex, _alloc);
+	}
+}
+
+ContextPool_::context_node_pck::~context_node_pck()
+{
+	for (int i = 0; i < 256; i++)
+	{
+		_contextPool[i].~context_pool_pck();
+	}
+	free(_contextPool);
+}
+
+ContextPool_::context_pool_pck& ContextPool_::context_node_pck::operator[](size_t i)
+{
+	assert(i < 256);
+	return _contextPool[i];
+}
 //////////////////////////////////////////////////////////////////////////
 
 ContextPool_* ContextPool_::_fiberPool = NULL;
@@ -45,8 +229,6 @@ void ContextPool_::install()
 #if (WIN32 && (defined CHECK_SELF) && (_WIN32_WINNT >= 0x0502))
 		ContextPool_::coro_pull_interface::_actorFlsIndex = FlsAlloc(NULL);
 #endif
-		ContextPool_::context_pool_pck::_mutex = new std::mutex;
-		ContextPool_::context_pool_pck::_alloc = new context_pool_pck::pool_queue::shared_node_alloc(MEM_POOL_LENGTH);
 		_fiberPool = new ContextPool_;
 	}
 }
@@ -56,10 +238,6 @@ void ContextPool_::uninstall()
 	if (_fiberPool)
 	{
 		delete _fiberPool;
-		delete ContextPool_::context_pool_pck::_mutex;
-		ContextPool_::context_pool_pck::_mutex = NULL;
-		delete ContextPool_::context_pool_pck::_alloc;
-		ContextPool_::context_pool_pck::_alloc = NULL;
 #if (WIN32 && (defined CHECK_SELF) && (_WIN32_WINNT >= 0x0502))
 		FlsFree(ContextPool_::coro_pull_interface::_actorFlsIndex);
 		ContextPool_::coro_pull_interface::_actorFlsIndex = -1;
@@ -69,8 +247,10 @@ void ContextPool_::uninstall()
 }
 
 ContextPool_::ContextPool_()
-:_exitSign(false), _clearWait(false), _stackCount(0), _stackTotalSize(0)
+:_exitSign(false), _clearWait(false), _nodePool(run_thread::numa_nodes().size()), _stackCount(0), _stackTotalSize(0), _budget(CONTEXT_STACK_BUDGET), _pressure(false),
+_sampling(false), _profile(new StackProfile_), _sampleTick(0)
 {
+	//ڵڸýڵ߳״ȡջʱŴnode_pool
 	run_thread th([this] { cleanThread(); });
 	_clearThread.swap(th);
 }
@@ -88,51 +268,137 @@ ContextPool_::~ContextPool_()
 	}
 	_clearThread.join();
 
-	int ic = 0;
-	for (int i = 0; i < 256; i++)
+	for (context_node_pck* const nodePool : _nodePool)
 	{
-		std::lock_guard<std::mutex> lg1(*_contextPool[i]._mutex);
-		while (!_contextPool[i]._pool.empty())
+		if (!nodePool)
 		{
-			coro_pull_interface* const pull = _contextPool[i]._pool.back();
-			_contextPool[i]._pool.pop_back();
-			context_yield::context_info* const info = pull->_coroInfo;
-			_stackCount--;
-			_stackTotalSize -= info->stackSize + info->reserveSize;
-			context_yield::delete_context(info);
-			delete pull;
+			continue;
 		}
-		while (!_contextPool[i]._decommitPool.empty())
+		std::lock_guard<std::mutex> lg1(nodePool->_mutex);
+		for (int i = 0; i < 256; i++)
 		{
-			coro_pull_interface* const pull = _contextPool[i]._decommitPool.back();
-			_contextPool[i]._decommitPool.pop_back();
-			context_yield::context_info* const info = pull->_coroInfo;
-			_stackCount--;
-			_stackTotalSize -= info->stackSize + info->reserveSize;
-			context_yield::delete_context(info);
-			delete pull;
+			context_pool_pck& contextPool = (*nodePool)[i];
+			while (!contextPool._pool.empty())
+			{
+				coro_pull_interface* const pull = contextPool._pool.back();
+				contextPool._pool.pop_back();
+				deleteContext(pull);
+			}
+			while (!contextPool._decommitPool.empty())
+			{
+				coro_pull_interface* const pull = contextPool._decommitPool.back();
+				contextPool._decommitPool.pop_back();
+				deleteContext(pull);
+			}
 		}
 	}
+	for (context_node_pck* const nodePool : _nodePool)
+	{
+		delete nodePool;
+	}
 	assert(0 == _stackCount);
 	assert(0 == _stackTotalSize);
+	assert(_registry.empty());
+	delete _profile;
+}
+
+void ContextPool_::tls_init()
+{
+	assert(_fiberPool);
+	context_cache* const cache = new context_cache;
+	memset(cache->_count, 0, sizeof(cache->_count));
+	io_engine::setTlsValue(CONTEXT_CACHE_INDEX, cache);
 }
 
-ContextPool_::coro_pull_interface* ContextPool_::getContext(size_t size)
+void ContextPool_::tls_uninit()
+{
+	context_cache* const cache = (context_cache*)io_engine::swapTlsValue(CONTEXT_CACHE_INDEX, NULL);
+	if (cache)
+	{
+		for (size_t i = 0; i < 256; i++)
+		{
+			if (cache->_count[i])
+			{
+				context_pool_pck& pool = (*_fiberPool->_nodePool[cache->_magazine[i][0]->_node])[i];
+				std::lock_guard<std::mutex> lg(*pool._mutex);
+				for (size_t j = 0; j < cache->_count[i]; j++)
+				{
+					pool._pool.push_back(cache->_magazine[i][j]);
+				}
+			}
+		}
+		delete cache;
+	}
+}
+
+ContextPool_::context_cache* ContextPool_::current_cache()
+{
+	void** const tlsBuff = io_engine::getTlsValueBuff();
+	return tlsBuff ? (context_cache*)tlsBuff[CONTEXT_CACHE_INDEX] : NULL;
+}
+
+size_t ContextPool_::current_node()
+{
+	const size_t node = io_engine::currentNode();
+	return node < _fiberPool->_nodePool.size() ? node : 0;
+}
+
+ContextPool_::context_node_pck* ContextPool_::node_pool(size_t node)
+{
+	context_node_pck* nodePool = _nodePool[node].load(std::memory_order_acquire);
+	if (!nodePool)
+	{//ɸýڵϵ߳״δͷ״ηڱڵڴ
+		std::lock_guard<std::mutex> lg(_nodeMutex);
+		nodePool = _nodePool[node].load(std::memory_order_relaxed);
+		if (!nodePool)
+		{
+			nodePool = new context_node_pck;
+			_nodePool[node].store(nodePool, std::memory_order_release);
+		}
+	}
+	return nodePool;
+}
+
+ContextPool_::coro_pull_interface* ContextPool_::getContext(size_t size, int flags)
 {
 	assert(size && size % MEM_PAGE_SIZE == 0 && size <= 1024 * 1024);
 	assert(context_yield::is_thread_a_fiber());
 	size = std::max(size, (size_t)CORO_CONTEXT_STATE_SPACE);
+	const size_t node = current_node();
+	context_cache* const cache = current_cache();
 	do
 	{
+		const size_t i = size / MEM_PAGE_SIZE - 1;
+		if (cache && cache->_count[i])
 		{
-			context_pool_pck& pool = _fiberPool->_contextPool[size / MEM_PAGE_SIZE - 1];
+			coro_pull_interface* oldFiber = cache->_magazine[i][--cache->_count[i]];
+			oldFiber->_tick = 0;
+			oldFiber->_flags = flags;
+			oldFiber->_live = true;
+			return oldFiber;
+		}
+		{
+			context_pool_pck& pool = (*_fiberPool->node_pool(node))[i];
 			pool._mutex->lock();
+			pool._allocCount++;
 			if (!pool._pool.empty())
 			{
 				coro_pull_interface* oldFiber = pool._pool.back();
 				pool._pool.pop_back();
+				if (cache)
+				{
+					//ͬһȡص̻߳棬֮ķ䲻ټ
+					while (cache->_count[i] < CONTEXT_CACHE_BATCH && !pool._pool.empty())
+					{
+						cache->_magazine[i][cache->_count[i]++] = pool._pool.back();
+						pool._pool.pop_back();
+						pool._allocCount++;
+					}
+				}
 				pool._mutex->unlock();
 				oldFiber->_tick = 0;
+				oldFiber->_flags = flags;
+				oldFiber->_live = true;
 				return oldFiber;
 			}
 			if (!pool._decommitPool.empty())
@@ -141,15 +407,27 @@ ContextPool_::coro_pull_interface* ContextPool_::getContext(size_t size)
 				pool._decommitPool.pop_back();
 				pool._mutex->unlock();
 				oldFiber->_tick = 0;
+				oldFiber->_flags = flags;
+				oldFiber->_live = true;
 				return oldFiber;
 			}
 			pool._mutex->unlock();
 		}
 		coro_pull_interface* newFiber = new coro_pull_interface;
 		newFiber->_tick = 0;
+		newFiber->_flags = flags;
+		newFiber->_node = node;
+		newFiber->_site = NULL;
+		newFiber->_live = true;
+		newFiber->_spill = NULL;
 		newFiber->_coroInfo = context_yield::make_context(size, ContextPool_::contextHandler, newFiber);
 		if (newFiber->_coroInfo)
 		{
+			{
+				std::lock_guard<std::mutex> lg(_fiberPool->_registryMutex);
+				newFiber->_registryIndex = _fiberPool->_registry.size();
+				_fiberPool->_registry.push_back(newFiber);
+			}
 			_fiberPool->_stackCount++;
 			_fiberPool->_stackTotalSize += newFiber->_coroInfo->stackSize + newFiber->_coroInfo->reserveSize;
 			return newFiber;
@@ -162,8 +440,46 @@ ContextPool_::coro_pull_interface* ContextPool_::getContext(size_t size)
 
 void ContextPool_::recovery(coro_pull_interface* pull)
 {
+	if (pull->_spill)
+	{
+		recovery_spill(pull);
+		return;
+	}
+	if (!context_yield::check_context(pull->_coroInfo))
+	{
+		//ջѸдջۣ޷ָ
+		trace_line("\nerror: ", "actor stack overflow");
+		abort();
+	}
+	if (pull->_flags & stack_lock)
+	{
+		context_yield::unlock_context(pull->_coroInfo);
+		pull->_flags &= ~stack_lock;
+	}
+	pull->_live = false;
 	pull->_tick = get_tick_s();
-	context_pool_pck& pool = _fiberPool->_contextPool[pull->_coroInfo->stackSize / MEM_PAGE_SIZE - 1];
+	const size_t i = pull->_coroInfo->stackSize / MEM_PAGE_SIZE - 1;
+	context_pool_pck& pool = (*_fiberPool->_nodePool[pull->_node])[i];
+	context_cache* const cache = current_cache();
+	if (cache && current_node() == pull->_node)
+	{
+		if (cache->_count[i] == CONTEXT_CACHE_SIZE)
+		{
+			//ϻһ黹ȫֳأ̰߳ʱϻ
+			std::lock_guard<std::mutex> lg(*pool._mutex);
+			for (size_t j = 0; j < CONTEXT_CACHE_BATCH; j++)
+			{
+				pool._pool.push_back(cache->_magazine[i][j]);
+			}
+			cache->_count[i] -= CONTEXT_CACHE_BATCH;
+			for (size_t j = 0; j < cache->_count[i]; j++)
+			{
+				cache->_magazine[i][j] = cache->_magazine[i][j + CONTEXT_CACHE_BATCH];
+			}
+		}
+		cache->_magazine[i][cache->_count[i]++] = pull;
+		return;
+	}
 	std::lock_guard<std::mutex> lg(*pool._mutex);
 	pool._pool.push_back(pull);
 }
@@ -188,6 +504,13 @@ void ContextPool_::contextHandler(context_yield::context_info* info, void* param
 			pull->_tick = 0;
 			context_yield::decommit_context(info);
 		}
+		if (pull->_flags & (stack_prefault | stack_lock | stack_huge_page))
+		{
+			if (!context_yield::prefault_context(info, 0 != (pull->_flags & stack_prefault), 0 != (pull->_flags & stack_huge_page), 0 != (pull->_flags & stack_lock)))
+			{
+				pull->_flags &= ~stack_lock;
+			}
+		}
 		coro_push_interface push = { info };
 		pull->_currentHandler(push, pull->_param);
 		if (pull->_tick)
@@ -197,6 +520,293 @@ void ContextPool_::contextHandler(context_yield::context_info* info, void* param
 	}
 }
 
+ContextPool_::coro_pull_interface* ContextPool_::getSpillContext(size_t promoteThreshold)
+{
+#ifdef WIN32
+	return NULL;
+#else
+	coro_pull_interface* const pull = new coro_pull_interface;
+	//Actorڶϣջ֡Կɷ
+	pull->_space = malloc(sizeof(my_actor)+64);
+#if (_DEBUG || DEBUG)
+	pull->_spaceSize = sizeof(my_actor)+64;
+#endif
+	pull->_tick = 0;
+	pull->_flags = stack_default;
+	pull->_node = current_node();
+	pull->_registryIndex = -1;
+	pull->_site = NULL;
+	pull->_live = true;
+	pull->_spill = new spill_context;
+	pull->_spill->_copy = NULL;
+	pull->_spill->_copyLow = NULL;
+	pull->_spill->_copyCapacity = 0;
+	pull->_spill->_swapCount = 0;
+	pull->_spill->_promoteThreshold = promoteThreshold;
+	pull->_spill->_idle = false;
+	pull->_spill->_promoted = false;
+	pull->_coroInfo = context_yield::make_context(SPILL_STACK_SIZE, ContextPool_::spillContextHandler, pull);
+	if (!pull->_coroInfo)
+	{
+		delete pull->_spill;
+		free(pull->_space);
+		delete pull;
+		return NULL;
+	}
+	return pull;
+#endif
+}
+
+void ContextPool_::recovery_spill(coro_pull_interface* pull)
+{
+	spill_context* const spill = pull->_spill;
+	if (!context_yield::check_context(pull->_coroInfo))
+	{
+		trace_line("\nerror: ", "actor stack overflow");
+		abort();
+	}
+	context_yield::delete_context(pull->_coroInfo);
+	free(spill->_copy);
+	delete spill;
+	free(pull->_space);
+	delete pull;
+}
+
+void ContextPool_::spillContextHandler(context_yield::context_info* info, void* param)
+{
+	coro_pull_interface* const pull = (coro_pull_interface*)param;
+	context_yield::push_yield(info);
+	coro_push_interface push = { info };
+	pull->_currentHandler(push, pull->_param);
+	while (true)
+	{
+		context_yield::push_yield(info);
+	}
+}
+
+void ContextPool_::idle_yield(coro_pull_interface* pull)
+{
+	if (pull->_spill)
+	{
+		pull->_spill->_idle = true;
+	}
+}
+
+void ContextPool_::save_stack(coro_pull_interface* pull)
+{
+	spill_context* const spill = pull->_spill;
+	if (!spill->_idle || spill->_promoted)
+	{
+		return;
+	}
+	spill->_idle = false;
+	context_yield::context_info* const info = pull->_coroInfo;
+	char* const top = (char*)info->stackTop;
+	//гʱľջ֡ʹ
+	char* const low = (char*)info->obj;
+	assert(low > top - info->stackSize - info->reserveSize && low < top);
+	const size_t size = top - low;
+	//尴ʵ䣬СʱҲ·
+	if (spill->_copyCapacity < size || spill->_copyCapacity / 4 > size)
+	{
+		free(spill->_copy);
+		spill->_copyCapacity = MEM_ALIGN(size, 256);
+		spill->_copy = (char*)malloc(spill->_copyCapacity);
+		if (!spill->_copy)
+		{
+			spill->_copyCapacity = 0;
+			return;
+		}
+	}
+	memcpy(spill->_copy, low, size);
+	spill->_copyLow = low;
+	context_yield::release_context(info);
+}
+
+void ContextPool_::restore_stack(coro_pull_interface* pull)
+{
+	spill_context* const spill = pull->_spill;
+	if (spill && spill->_copyLow)
+	{
+		memcpy(spill->_copyLow, spill->_copy, (char*)pull->_coroInfo->stackTop - spill->_copyLow);
+		spill->_copyLow = NULL;
+		if (spill->_promoteThreshold && ++spill->_swapCount >= spill->_promoteThreshold)
+		{
+			//ƵActorٻջ֡פԼջ
+			spill->_promoted = true;
+			free(spill->_copy);
+			spill->_copy = NULL;
+			spill->_copyCapacity = 0;
+		}
+	}
+}
+
+static bool read_size_file(const std::string& path, unsigned long long& val)
+{
+	std::ifstream file(path);
+	std::string str;
+	if (!(file >> str) || str.empty() || str[0] < '0' || str[0] > '9')
+	{
+		return false;
+	}
+	val = strtoull(str.c_str(), NULL, 10);
+	return true;
+}
+
+static bool read_stat_field(const std::string& path, const char* key, unsigned long long& val)
+{
+	//memory.statÿ" ֵ"
+	std::ifstream file(path);
+	std::string name;
+	unsigned long long num = 0;
+	while (file >> name >> num)
+	{
+		if (name == key)
+		{
+			val = num;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool memory_pressure()
+{
+#ifdef WIN32
+	MEMORYSTATUSEX status;
+	status.dwLength = sizeof(status);
+	return GlobalMemoryStatusEx(&status) && status.dwMemoryLoad >= CONTEXT_PRESSURE_PERCENT;
+#elif __linux__
+	unsigned long long usage = 0, limit = 0;
+	static const std::string cgroupPath = []()->std::string
+	{
+		//cgroup v2±ڵĿ飬"0::/path"
+		std::ifstream file("/proc/self/cgroup");
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (0 == line.compare(0, 3, "0::"))
+			{
+				return "/sys/fs/cgroup" + line.substr(3);
+			}
+		}
+		return std::string();
+	}();
+	if (!cgroupPath.empty())
+	{
+		//PSI10ȴڴͣٵʱռ
+		std::ifstream psi(cgroupPath + "/memory.pressure");
+		std::string some, avg10;
+		if (psi >> some >> avg10 && "some" == some && 0 == avg10.compare(0, 6, "avg10="))
+		{
+			if (atof(avg10.c_str() + 6) >= CONTEXT_PRESSURE_STALL)
+			{
+				return true;
+			}
+		}
+		//memory.currentɻյҳ棬ֻڴ
+		if (read_stat_field(cgroupPath + "/memory.stat", "anon", usage) && read_size_file(cgroupPath + "/memory.max", limit))
+		{
+			return usage * 100 >= limit * CONTEXT_PRESSURE_PERCENT;
+		}
+		return false;
+	}
+	if (read_stat_field("/sys/fs/cgroup/memory/memory.stat", "total_rss", usage) && read_size_file("/sys/fs/cgroup/memory/memory.limit_in_bytes", limit))
+	{
+		return usage * 100 >= limit * CONTEXT_PRESSURE_PERCENT;
+	}
+	return false;
+#endif
+}
+
+void ContextPool_::set_budget(size_t budget)
+{
+	assert(_fiberPool);
+	_fiberPool->_budget = budget;
+}
+
+size_t ContextPool_::trim()
+{
+	assert(_fiberPool);
+	size_t freeSize = 0;
+	std::vector<coro_pull_interface*> pulls;
+	for (context_node_pck* const nodePool : _fiberPool->_nodePool)
+	{
+		if (!nodePool)
+		{
+			continue;
+		}
+		for (int i = 0; i < 256; i++)
+		{
+			context_pool_pck& contextPool = (*nodePool)[i];
+			{
+				std::lock_guard<std::mutex> lg(*contextPool._mutex);
+				while (!contextPool._pool.empty())
+				{
+					pulls.push_back(contextPool._pool.back());
+					contextPool._pool.pop_back();
+				}
+				while (!contextPool._decommitPool.empty())
+				{
+					pulls.push_back(contextPool._decommitPool.back());
+					contextPool._decommitPool.pop_back();
+				}
+			}
+			for (coro_pull_interface* const pull : pulls)
+			{
+				freeSize += pull->_coroInfo->stackSize + pull->_coroInfo->reserveSize;
+				_fiberPool->deleteContext(pull);
+			}
+			pulls.clear();
+		}
+	}
+	return freeSize;
+}
+
+ContextPool_::pool_stats ContextPool_::stats()
+{
+	assert(_fiberPool);
+	pool_stats res;
+	res.stackCount = (size_t)_fiberPool->_stackCount;
+	res.stackTotalSize = _fiberPool->_stackTotalSize;
+	res.idleCount = 0;
+	res.decommitCount = 0;
+	res.budget = _fiberPool->_budget;
+	res.pressure = _fiberPool->_pressure;
+	for (context_node_pck* const nodePool : _fiberPool->_nodePool)
+	{
+		if (!nodePool)
+		{
+			continue;
+		}
+		std::lock_guard<std::mutex> lg(nodePool->_mutex);
+		for (int i = 0; i < 256; i++)
+		{
+			res.idleCount += (*nodePool)[i]._pool.size();
+			res.decommitCount += (*nodePool)[i]._decommitPool.size();
+		}
+	}
+	return res;
+}
+
+void ContextPool_::deleteContext(coro_pull_interface* pull)
+{
+	context_yield::context_info* const info = pull->_coroInfo;
+	//ȴеɨɨעȡջ
+	std::lock_guard<std::mutex> sg(_scanMutex);
+	{
+		std::lock_guard<std::mutex> lg(_registryMutex);
+		coro_pull_interface* const last = _registry.back();
+		_registry[pull->_registryIndex] = last;
+		last->_registryIndex = pull->_registryIndex;
+		_registry.pop_back();
+	}
+	_stackCount--;
+	_stackTotalSize -= info->stackSize + info->reserveSize;
+	context_yield::delete_context(info);
+	delete pull;
+}
+
 void ContextPool_::cleanThread()
 {
 	run_thread::set_current_thread_name("actor stack clean thread");
@@ -209,64 +819,189 @@ void ContextPool_::cleanThread()
 				break;
 			}
 			_clearWait = true;
-			if (std::cv_status::no_timeout == _clearVar.wait_for(ul, std::chrono::seconds(CONTEXT_MIN_CLEAN_CYCLE)) || !_clearWait)
+			if (std::cv_status::no_timeout == _clearVar.wait_for(ul, std::chrono::milliseconds(CONTEXT_CLEAN_TICK)) || !_clearWait)
 			{
 				break;
 			}
 			_clearWait = false;
 		}
-		bool freeSign = false;
+		//Ԥڴѹ²ٱջ
+		const size_t budget = _budget;
+		const bool pressure = memory_pressure();
+		_pressure = pressure;
+		const bool trimAll = pressure || (budget && _stackTotalSize > budget);
+		bool moreSign = false;
+		bool firstRound = true;
 		do
 		{
+			if (moreSign)
 			{
 				std::unique_lock<std::mutex> ul(_clearMutex);
 				if (_exitSign)
 				{
 					break;
 				}
-				if (freeSign)
+				_clearWait = true;
+				if (std::cv_status::no_timeout == _clearVar.wait_for(ul, std::chrono::milliseconds(1)) || !_clearWait)
 				{
-					_clearWait = true;
-					if (std::cv_status::no_timeout == _clearVar.wait_for(ul, std::chrono::milliseconds(1)) || !_clearWait)
-					{
-						break;
-					}
-					_clearWait = false;
+					break;
 				}
+				_clearWait = false;
 			}
-			freeSign = false;
-			int extTick = get_tick_s();
-			for (int i = 255; i >= 0; i--)
+			moreSign = false;
+			const int extTick = get_tick_s();
+			for (size_t j = 0; j < _nodePool.size() * 256; j++)
 			{
-				context_pool_pck& contextPool = _contextPool[i];
-				contextPool._mutex->lock();
-				if (!contextPool._pool.empty() && extTick - contextPool._pool.front()->_tick >= CONTEXT_MIN_CLEAN_CYCLE)
+				context_node_pck* const nodePool = _nodePool[j / 256].load(std::memory_order_acquire);
+				if (nodePool)
 				{
-					coro_pull_interface* const pull = contextPool._pool.front();
-					contextPool._pool.pop_front();
-					contextPool._mutex->unlock();
-					freeSign = true;
-					context_yield::decommit_context(pull->_coroInfo);
-					contextPool._mutex->lock();
-					contextPool._decommitPool.push_back(pull);
+					moreSign |= cleanPool((*nodePool)[255 - j % 256], extTick, trimAll, firstRound);
 				}
-				if (!contextPool._decommitPool.empty() && extTick - contextPool._decommitPool.front()->_tick >= CONTEXT_MIN_DELETE_CYCLE)
-				{
-					coro_pull_interface* const pull = contextPool._decommitPool.front();
-					contextPool._decommitPool.pop_front();
-					contextPool._mutex->unlock();
-					freeSign = true;
-					_stackCount--;
-					context_yield::context_info* const info = pull->_coroInfo;
-					_stackTotalSize -= info->stackSize + info->reserveSize;
-					context_yield::delete_context(info);
-					delete pull;
-				}
-				else
+			}
+			firstRound = false;
+		} while (moreSign);
+		if (_sampling && 0 == ++_sampleTick % STACK_SAMPLE_CYCLE)
+		{
+			sampleLive(*_profile);
+		}
+	}
+}
+
+void ContextPool_::sampleLive(StackProfile_& profile)
+{
+	//ֻעmincoreɨ裬ջĴע
+	std::vector<std::pair<const std::type_info*, context_yield::context_info>> live;
+	std::lock_guard<std::mutex> sg(_scanMutex);
+	{
+		std::lock_guard<std::mutex> lg(_registryMutex);
+		live.reserve(_registry.size());
+		for (coro_pull_interface* const pull : _registry)
+		{
+			const std::type_info* const site = pull->_site;
+			if (pull->_live && site)
+			{
+				live.push_back(std::make_pair(site, *pull->_coroInfo));
+			}
+		}
+	}
+	std::vector<size_t> used(live.size());
+	for (size_t i = 0; i < live.size(); i++)
+	{
+		used[i] = context_yield::stack_used_size(&live[i].second);
+	}
+	std::lock_guard<std::mutex> lg(_registryMutex);
+	for (size_t i = 0; i < live.size(); i++)
+	{
+		profile.add(live[i].first, live[i].second.stackSize, used[i]);
+	}
+}
+
+void ContextPool_::set_sampling(bool enable)
+{
+	assert(_fiberPool);
+	_fiberPool->_sampling = enable;
+}
+
+std::vector<ContextPool_::stack_site_stats> ContextPool_::sampled_sites()
+{
+	assert(_fiberPool);
+	std::lock_guard<std::mutex> lg(_fiberPool->_registryMutex);
+	return _fiberPool->_profile->report();
+}
+
+std::vector<ContextPool_::stack_site_stats> ContextPool_::scan_sites()
+{
+	assert(_fiberPool);
+	StackProfile_ profile;
+	_fiberPool->sampleLive(profile);
+	return profile.report();
+}
+
+bool ContextPool_::cleanPool(context_pool_pck& contextPool, int extTick, bool trimAll, bool updateDemand)
+{
+	coro_pull_interface* decommitList[CONTEXT_CLEAN_BATCH];
+	coro_pull_interface* deleteList[CONTEXT_CLEAN_BATCH];
+	size_t decommitCount = 0;
+	size_t deleteCount = 0;
+	{
+		std::lock_guard<std::mutex> lg(*contextPool._mutex);
+		if (updateDemand)
+		{
+			//Ŀȡÿȡķֵ˥
+			const size_t decay = (contextPool._demand + CONTEXT_DEMAND_DECAY - 1) / CONTEXT_DEMAND_DECAY;
+			contextPool._demand = std::max(contextPool._allocCount, contextPool._demand - decay);
+			contextPool._allocCount = 0;
+		}
+		const size_t target = trimAll ? 0 : contextPool._demand;
+		size_t keepCount = 0;
+		while (decommitCount < CONTEXT_CLEAN_BATCH && !contextPool._pool.empty())
+		{
+			if (!trimAll && (contextPool._pool.front()->_flags & stack_no_decommit))
+			{
+				//յջתβһֶջʱ
+				if (++keepCount > contextPool._pool.size())
 				{
-					contextPool._mutex->unlock();
+					break;
 				}
+				contextPool._pool.front()->_tick = extTick;
+				contextPool._pool.push_back(contextPool._pool.front());
+				contextPool._pool.pop_front();
+				continue;
+			}
+			//ĿڵĿջύ̬·ȱҳͻ󳬳϶ľ黹İ̶
+			const size_t size = contextPool._pool.size();
+			const int idle = extTick - contextPool._pool.front()->_tick;
+			if (!trimAll && (size <= target || idle < (size - target > CONTEXT_CACHE_SIZE ? CONTEXT_MIN_TRIM_CYCLE : CONTEXT_MIN_CLEAN_CYCLE)))
+			{
+				break;
 			}
-		} while (freeSign);
+			decommitList[decommitCount++] = contextPool._pool.front();
+			contextPool._pool.pop_front();
+		}
+		while (deleteCount < CONTEXT_CLEAN_BATCH && !contextPool._decommitPool.empty())
+		{
+			if (!trimAll && extTick - contextPool._decommitPool.front()->_tick < CONTEXT_MIN_DELETE_CYCLE)
+			{
+				break;
+			}
+			deleteList[deleteCount++] = contextPool._decommitPool.front();
+			contextPool._decommitPool.pop_front();
+		}
+	}
+	if (_sampling && decommitCount)
+	{
+		//黹ڴǰ¼ˮλΪϴι黹ùջActorеһʹߵĴϣ
+		//ЩջƳгأɨ費Ҫ
+		size_t used[CONTEXT_CLEAN_BATCH];
+		for (size_t i = 0; i < decommitCount; i++)
+		{
+			used[i] = decommitList[i]->_site ? context_yield::stack_used_size(decommitList[i]->_coroInfo) : 0;
+		}
+		std::lock_guard<std::mutex> lg(_registryMutex);
+		for (size_t i = 0; i < decommitCount; i++)
+		{
+			const std::type_info* const site = decommitList[i]->_site;
+			if (site)
+			{
+				_profile->add(site, decommitList[i]->_coroInfo->stackSize, used[i]);
+			}
+		}
+	}
+	for (size_t i = 0; i < decommitCount; i++)
+	{
+		context_yield::decommit_context(decommitList[i]->_coroInfo);
+	}
+	if (decommitCount)
+	{
+		std::lock_guard<std::mutex> lg(*contextPool._mutex);
+		for (size_t i = 0; i < decommitCount; i++)
+		{
+			contextPool._decommitPool.push_back(decommitList[i]);
+		}
+	}
+	for (size_t i = 0; i < deleteCount; i++)
+	{
+		deleteContext(deleteList[i]);
 	}
+	return CONTEXT_CLEAN_BATCH == decommitCount || CONTEXT_CLEAN_BATCH == deleteCount;
 }
\ No newline at end of file
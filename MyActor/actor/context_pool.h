@@ -3,12 +3,48 @@
 
 #include <mutex>
 #include <atomic>
+#include <vector>
 #include <string>
+#include <typeinfo>
 #include <condition_variable>
 #include "msg_queue.h"
 #include "context_yield.h"
 #include "run_thread.h"
 
+//ÿ߳ÿߴ໺context/ȡʱÿһ
+#ifndef CONTEXT_CACHE_SIZE
+#define CONTEXT_CACHE_SIZE 16
+#endif
+
+//ջʱÿ㱣
+#ifndef STACK_SAMPLE_RESERVOIR
+#define STACK_SAMPLE_RESERVOIR 256
+#endif
+
+//лջActorջߴ磬ÿActorռһջۣȴϢڼջ֡ϲ黹ջڴ
+#ifndef SPILL_STACK_SIZE
+#define SPILL_STACK_SIZE (256 kB - STACK_RESERVED_SPACE_SIZE)
+#endif
+
+//лջActorĬϵĽֵﵽٻջ֡פԼջϣ0
+#ifndef SPILL_STACK_PROMOTE
+#define SPILL_STACK_PROMOTE 1024
+#endif
+
+/*!
+@brief ActorջѡϣӳеActor
+*/
+enum stack_flag
+{
+	stack_default = 0,
+	stack_prefault = 1,//ʱԤȴջв״ʹȱҳ
+	stack_lock = 2,//ջڴ治(mlock/VirtualLock)Actor˳
+	stack_no_decommit = 4,//Actor˳ջ黹ڴ棬غҲ̻߳(trim)
+	stack_huge_page = 8//͸ҳջ(linux)ջҳʱЧ
+};
+
+struct StackProfile_;
+
 /*!
 @brief context
 */
@@ -16,6 +52,7 @@ class ContextPool_
 {
 public:
 	struct coro_push_interface;
+	struct spill_context;
 	typedef void(*coro_handler)(coro_push_interface& push, void* param);
 public:
 	struct coro_push_interface
@@ -34,6 +71,12 @@ public:
 		void* _param;
 		void* _space;
 		int _tick;
+		int _flags;//stack_flagϣһȡ߸contextActor
+		size_t _node;
+		size_t _registryIndex;//ȫcontextǼǱеλ
+		std::atomic<const std::type_info*> _site;//㣬ȡActorں
+		std::atomic<bool> _live;//Actorʹ
+		spill_context* _spill;//NULLʱǿлջActorȴϢڼջ֡ɱ
 #if (_DEBUG || DEBUG)
 		size_t _spaceSize;
 #endif
@@ -46,33 +89,153 @@ private:
 	{
 		typedef msg_list_shared_alloc<coro_pull_interface*, pool_alloc_mt<void, mem_alloc_mt2<void, null_mutex> > > pool_queue;
 
-		context_pool_pck()
-		:_pool(*_alloc), _decommitPool(*_alloc){}
+		context_pool_pck(std::mutex& mutex, pool_queue::shared_node_alloc& alloc)
+		:_mutex(&mutex), _pool(alloc), _decommitPool(alloc), _allocCount(0), _demand(0){}
+		std::mutex* const _mutex;
 		pool_queue _pool;
 		pool_queue _decommitPool;
-		static std::mutex* _mutex;
-		static pool_queue::shared_node_alloc* _alloc;
+		size_t _allocCount;//ڴȫֳȡߵcontext
+		size_t _demand;//ÿڵֵ(˥)ΪջĿ
+	};
+
+	//ÿNUMAڵһջڵ߳ϴպҲֻڱڵ㸴
+	struct context_node_pck
+	{
+		context_node_pck();
+		~context_node_pck();
+		context_pool_pck& operator[](size_t i);
+
+		std::mutex _mutex;
+		context_pool_pck::pool_queue::shared_node_alloc _alloc;
+		context_pool_pck* _contextPool;
+		NONE_COPY(context_node_pck);
+	};
+
+	//̱߳صcontext棬ÿߴһϻʱ黹ȫֳأʱȫֳȡأֻ汾ڵջ
+	struct context_cache
+	{
+		size_t _count[256];
+		coro_pull_interface* _magazine[256][CONTEXT_CACHE_SIZE];
+	};
+public:
+	/*!
+	@brief ջͳ
+	*/
+	struct pool_stats
+	{
+		size_t stackCount;//Ѵջ(ʹ)
+		size_t stackTotalSize;//Ѵջռõĵַռ
+		size_t idleCount;//ȫֳбύĿջ
+		size_t decommitCount;//ȫֳѹ黹ڴĿջ
+		size_t budget;//ջַռԤ㣬0
+		bool pressure;//һμʱڴѹ
+	};
+
+	/*!
+	@brief (Actorں)ͳƵջΪջפҳľ
+	*/
+	struct stack_site_stats
+	{
+		std::string site;//
+		size_t count;//ʱɨʱΪеActor
+		size_t p50;
+		size_t p99;
+		size_t max;
+		size_t stackSize;//ôջߴ
+		size_t unused;//ƽÿδõջֽ
 	};
 public:
 	ContextPool_();
 	~ContextPool_();
 public:
-	static coro_pull_interface* getContext(size_t size);
+	static coro_pull_interface* getContext(size_t size, int flags = stack_default);
 	static void recovery(coro_pull_interface* coro);
 	static void install();
 	static void uninstall();
+
+	/*!
+	@brief ߳/˳ʱ/ձ߳context棬˳ʱ黹ȫֳ
+	*/
+	static void tls_init();
+	static void tls_uninit();
+
+	/*!
+	@brief һлջcontext(ռջۣcontext)idle_yieldǵĵȴгòջ֡ϲ黹ջڴ棬
+	ջַ䣬ⲿдջ϶ǰrestore_stack
+	@param promoteThreshold ﵽٻ0
+	@return ֵ֧ƽ̨NULL
+	*/
+	static coro_pull_interface* getSpillContext(size_t promoteThreshold);
+
+	/*!
+	@brief лջcontextڵȴггջ֡ɱڸcontextջϵ
+	*/
+	static void idle_yield(coro_pull_interface* pull);
+
+	/*!
+	@brief лջcontextջ֡ѱʱԭλstrandдȴеActorջ϶ǰãcontext޲
+	*/
+	static void restore_stack(coro_pull_interface* pull);
+
+	/*!
+	@brief ջַռԤ㣬ʱ߳ȫֳеĿջ0
+	*/
+	static void set_budget(size_t budget);
+
+	/*!
+	@brief ͷȫֳпջ(̱߳ػ治Ӱ)ͷŵĵַռ
+	*/
+	static size_t trim();
+
+	/*!
+	@brief ȡջͳ
+	*/
+	static pool_stats stats();
+
+	/*!
+	@brief ջ߳ڹ黹ջڴǰ¼ˮλɨеActorջ
+	*/
+	static void set_sampling(bool enable);
+
+	/*!
+	@brief ۻĸջ
+	*/
+	static std::vector<stack_site_stats> sampled_sites();
+
+	/*!
+	@brief ɨеActorջ(ۻ)
+	*/
+	static std::vector<stack_site_stats> scan_sites();
 private:
 	static void contextHandler(context_yield::context_info* info, void* param);
+	static void spillContextHandler(context_yield::context_info* info, void* param);
+	static void save_stack(coro_pull_interface* pull);
+	static void recovery_spill(coro_pull_interface* pull);
+	static context_cache* current_cache();
+	static size_t current_node();
+	context_node_pck* node_pool(size_t node);
 	void cleanThread();
+	bool cleanPool(context_pool_pck& contextPool, int extTick, bool trimAll, bool updateDemand);
+	void deleteContext(coro_pull_interface* pull);
+	void sampleLive(StackProfile_& profile);
 private:
 	volatile bool _exitSign;
 	volatile bool _clearWait;
-	context_pool_pck _contextPool[256];
+	std::vector<std::atomic<context_node_pck*> > _nodePool;
+	std::mutex _nodeMutex;
 	std::mutex _clearMutex;
 	run_thread _clearThread;
 	std::atomic<int> _stackCount;
 	std::condition_variable _clearVar;
 	std::atomic<size_t> _stackTotalSize;
+	std::atomic<size_t> _budget;
+	std::atomic<bool> _pressure;
+	std::mutex _registryMutex;
+	std::mutex _scanMutex;
+	std::vector<coro_pull_interface*> _registry;
+	std::atomic<bool> _sampling;
+	StackProfile_* _profile;
+	size_t _sampleTick;
 	static ContextPool_* _fiberPool;
 };
 
@@ -9,6 +9,54 @@
 #endif
 #elif __linux__
 #include <sys/mman.h>
+#include <mutex>
+#include <vector>
+#include <atomic>
+#endif
+
+#if (defined __linux__) && (defined ENABLE_STACK_ARENA)
+//ÿԤջַռ䣬ֻռַռڴ棬ջߴгɵȳջ
+#ifndef STACK_ARENA_CHUNK_SIZE
+#define STACK_ARENA_CHUNK_SIZE (256 * 1024 kB)
+#endif
+
+#define STACK_ARENA_CLASSES (MEM_ALIGN(1024 kB + STACK_RESERVED_SPACE_SIZE, STACK_BLOCK_SIZE) / STACK_BLOCK_SIZE + 1)
+#define STACK_CANARY_WORDS 8
+
+//Ĭÿջڱҳÿ۶ռһӳ䣻ڱҳֻռһӳ䣬ջд˿ȸֵÿгactorʱ
+//#define STACK_ARENA_NO_GUARD_PAGE
+
+static_assert(STACK_ARENA_CHUNK_SIZE >= STACK_BLOCK_SIZE && STACK_ARENA_CHUNK_SIZE % MEM_PAGE_SIZE == 0, "");
+#endif
+
+#if (defined __linux__) && (defined ENABLE_GROWABLE_STACK)
+//ջÿջԤĵַռ䣬ջӲ۶۵һҳΪڱ
+#ifndef GROWABLE_STACK_SLOT
+#define GROWABLE_STACK_SLOT (1024 kB)
+#endif
+
+//ÿԤջ
+#ifndef GROWABLE_STACK_CHUNK_SLOTS
+#define GROWABLE_STACK_CHUNK_SLOTS 1024
+#endif
+
+//ԤĿźŴаջ
+#ifndef GROWABLE_STACK_MAX_CHUNKS
+#define GROWABLE_STACK_MAX_CHUNKS 1024
+#endif
+
+//ȱҳչʱŵҳµĳߴ(ҳ)
+#ifndef GROWABLE_STACK_STEP
+#define GROWABLE_STACK_STEP (16 kB)
+#endif
+
+#define GROWABLE_STACK_CHUNK_SIZE ((size_t)GROWABLE_STACK_SLOT * GROWABLE_STACK_CHUNK_SLOTS)
+#define STACK_SLOT_SIZE(__s__) ((size_t)GROWABLE_STACK_SLOT)
+
+static_assert(GROWABLE_STACK_SLOT % MEM_PAGE_SIZE == 0 && GROWABLE_STACK_SLOT >= MEM_ALIGN(MAX_STACKSIZE + STACK_RESERVED_SPACE_SIZE, STACK_BLOCK_SIZE), "");
+static_assert(GROWABLE_STACK_STEP % MEM_PAGE_SIZE == 0 && GROWABLE_STACK_STEP >= MEM_PAGE_SIZE, "");
+#else
+#define STACK_SLOT_SIZE(__s__) (__s__)
 #endif
 
 namespace context_yield
@@ -127,6 +175,61 @@ namespace context_yield
 		adjust_stack(info);
 	}
 
+	void release_context(context_yield::context_info* info)
+	{
+		//fiberջPAGE_GUARDҳύ黹ٴӵ͵ַд
+	}
+
+	bool prefault_context(context_yield::context_info* info, bool touch, bool hugePage, bool lock)
+	{
+		char* const low = (char*)info->stackTop - info->stackSize;
+		if (touch || lock)
+		{
+			//fiberջPAGE_GUARDҳύӵǰջʼδ
+			for (char* p = (char*)((size_t)get_sp() & (0 - (size_t)MEM_PAGE_SIZE)) - MEM_PAGE_SIZE; p >= low; p -= MEM_PAGE_SIZE)
+			{
+				*(volatile char*)p = *(volatile char*)p;
+			}
+		}
+		return !lock || FALSE != VirtualLock(low, info->stackSize);
+	}
+
+	void unlock_context(context_yield::context_info* info)
+	{
+		VirtualUnlock((char*)info->stackTop - info->stackSize, info->stackSize);
+	}
+
+	size_t stack_used_size(context_yield::context_info* info)
+	{
+		//ջϱδύһҳPAGE_GUARDδõĲ
+		const size_t totalStackSize = info->stackSize + info->reserveSize;
+		char* const sb = (char*)info->stackTop - totalStackSize;
+		MEMORY_BASIC_INFORMATION mbi;
+		VirtualQuery(sb, &mbi, sizeof(mbi));
+		assert(sb == mbi.AllocationBase);
+		if (MEM_RESERVE == mbi.State)
+		{
+			assert(0 == mbi.Protect);
+			return totalStackSize - mbi.RegionSize - MEM_PAGE_SIZE;
+		}
+		else if ((PAGE_READWRITE | PAGE_GUARD) == mbi.Protect)
+		{
+			assert(MEM_COMMIT == mbi.State && MEM_PAGE_SIZE == mbi.RegionSize);
+			return totalStackSize - MEM_PAGE_SIZE;
+		}
+		return totalStackSize;
+	}
+
+	bool check_context(context_yield::context_info* info)
+	{
+		return true;
+	}
+
+	bool grow_stack(void* faultAddr, void* sp)
+	{
+		return false;
+	}
+
 #elif __linux__
 
 struct transfer_t
@@ -149,20 +252,167 @@ struct transfer_t
 	bool convert_thread_to_fiber() {return false; }
 	bool convert_fiber_to_thread() {return false; }
 
-	context_yield::context_info* make_context(size_t stackSize, context_yield::context_handler handler, void* p)
+#ifdef ENABLE_GROWABLE_STACK
+	/*!
+	@brief ÿջռһ̶СջֻۣŲ۶ĳߴ磬ֱ۵ڱҳPROT_NONE
+	ԽʱSIGSEGVgrow_stackչջ۴ӴԤĵַռзַֻ֣ɾźŴ
+	*/
+	struct grow_arena
 	{
-		size_t allocSize = MEM_ALIGN(stackSize + STACK_RESERVED_SPACE_SIZE, STACK_BLOCK_SIZE);
-		void* stack = mmap(0, allocSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);//ڴ㹻¿ʧܣ /proc/sys/vm/max_map_count
-		if (!stack)
+		std::mutex _mutex;
+		std::vector<char*> _freeSlots;
+		size_t _chunkCount = 0;
+		size_t _chunkUsed = 0;
+	};
+
+	static grow_arena s_growArena;
+	static std::atomic<char*> s_growChunks[GROWABLE_STACK_MAX_CHUNKS];
+
+	static void* alloc_stack(size_t allocSize)
+	{
+		assert(allocSize <= GROWABLE_STACK_SLOT);
+		char* slot = NULL;
+		{
+			std::lock_guard<std::mutex> lg(s_growArena._mutex);
+			if (!s_growArena._freeSlots.empty())
+			{
+				slot = s_growArena._freeSlots.back();
+				s_growArena._freeSlots.pop_back();
+			}
+			else
+			{
+				if (!s_growArena._chunkCount || GROWABLE_STACK_CHUNK_SLOTS == s_growArena._chunkUsed)
+				{
+					if (GROWABLE_STACK_MAX_CHUNKS == s_growArena._chunkCount)
+					{
+						return NULL;
+					}
+					//ֻԤַռ䣬ɷ
+					void* const chunk = mmap(0, GROWABLE_STACK_CHUNK_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+					if (MAP_FAILED == chunk)
+					{
+						return NULL;
+					}
+					s_growChunks[s_growArena._chunkCount++].store((char*)chunk, std::memory_order_release);
+					s_growArena._chunkUsed = 0;
+				}
+				slot = s_growChunks[s_growArena._chunkCount - 1].load(std::memory_order_relaxed) + s_growArena._chunkUsed++ * GROWABLE_STACK_SLOT;
+			}
+		}
+		//Ų۶ĳߴ(ڱҳ)ȱҳʱչ
+		char* const top = slot + GROWABLE_STACK_SLOT;
+		if (0 != mprotect(top - allocSize + MEM_PAGE_SIZE, allocSize - MEM_PAGE_SIZE, PROT_READ | PROT_WRITE))
+		{
+			std::lock_guard<std::mutex> lg(s_growArena._mutex);
+			s_growArena._freeSlots.push_back(slot);
+			return NULL;
+		}
+		return slot;
+	}
+
+	static void free_stack(void* stack, size_t allocSize)
+	{
+		assert(GROWABLE_STACK_SLOT == allocSize);
+		//黹ڴ沢ջѿŵĲַ֣ռڿби
+		madvise((char*)stack + MEM_PAGE_SIZE, allocSize - MEM_PAGE_SIZE, MADV_DONTNEED);
+		mprotect((char*)stack + MEM_PAGE_SIZE, allocSize - MEM_PAGE_SIZE, PROT_NONE);
+		std::lock_guard<std::mutex> lg(s_growArena._mutex);
+		s_growArena._freeSlots.push_back((char*)stack);
+	}
+#elif (defined ENABLE_STACK_ARENA)
+	/*!
+	@brief ͬһߴջӴԤĵַռз֣ͷŵջ۹黹ڴбã
+	Ĭÿջ״гʱmprotectһڱҳSTACK_ARENA_NO_GUARD_PAGEֻռһӳ䣬ջ׵һҳд˿ȸֵ
+	*/
+	struct stack_arena
+	{
+		std::mutex _mutex;
+		std::vector<char*> _freeSlots;
+		char* _chunk = NULL;
+		size_t _chunkUsed = 0;
+	};
+
+	static stack_arena s_stackArena[STACK_ARENA_CLASSES];
+
+	static size_t stack_canary(void* stack, size_t i)
+	{
+		return ((size_t)stack >> 4) ^ ((size_t)0x9E3779B97F4A7C15ULL * (i + 1));
+	}
+
+	static void* alloc_stack(size_t allocSize)
+	{
+		assert(allocSize % STACK_BLOCK_SIZE == 0 && allocSize / STACK_BLOCK_SIZE < STACK_ARENA_CLASSES);
+		stack_arena& arena = s_stackArena[allocSize / STACK_BLOCK_SIZE];
+		char* stack = NULL;
+		{
+			std::lock_guard<std::mutex> lg(arena._mutex);
+			if (!arena._freeSlots.empty())
+			{
+				stack = arena._freeSlots.back();
+				arena._freeSlots.pop_back();
+			}
+			else
+			{
+				const size_t chunkSize = std::max((size_t)STACK_ARENA_CHUNK_SIZE / allocSize, (size_t)1) * allocSize;
+				if (!arena._chunk || arena._chunkUsed + allocSize > chunkSize)
+				{
+					//ֻԤַռ䣬ڴ״ηʱŷ
+					void* const chunk = mmap(0, chunkSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+					if (MAP_FAILED == chunk)
+					{
+						return NULL;
+					}
+					arena._chunk = (char*)chunk;
+					arena._chunkUsed = 0;
+				}
+				stack = arena._chunk + arena._chunkUsed;
+				arena._chunkUsed += allocSize;
+#ifndef STACK_ARENA_NO_GUARD_PAGE
+				//ڱҳֻջ״гʱãʱ
+				bool ok = 0 == mprotect(stack, MEM_PAGE_SIZE, PROT_NONE);
+				assert(ok);
+#endif
+			}
+		}
+#ifdef STACK_ARENA_NO_GUARD_PAGE
+		for (size_t i = 0; i < STACK_CANARY_WORDS; i++)
+		{
+			((size_t*)stack)[i] = stack_canary(stack, i);
+		}
+#endif
+		return stack;
+	}
+
+	static void free_stack(void* stack, size_t allocSize)
+	{
+		//黹ڴ棬ַռڿби
+		madvise((char*)stack + MEM_PAGE_SIZE, allocSize - MEM_PAGE_SIZE, MADV_DONTNEED);
+		stack_arena& arena = s_stackArena[allocSize / STACK_BLOCK_SIZE];
+		std::lock_guard<std::mutex> lg(arena._mutex);
+		arena._freeSlots.push_back((char*)stack);
+	}
+#else
+	static void* alloc_stack(size_t allocSize)
+	{
+		void* stack = mmap(0, allocSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);//ڴ㹻¿ʧܣ /proc/sys/vm/max_map_count ENABLE_STACK_ARENA
+		if (MAP_FAILED == stack)
 		{
 			return NULL;
 		}
-		context_yield::context_info* info = new context_yield::context_info;
-		info->stackTop = (char*)stack + allocSize;
-		info->stackSize = stackSize;
-		info->reserveSize = allocSize - info->stackSize;
 		bool ok = 0 == mprotect(stack, MEM_PAGE_SIZE, PROT_NONE);//ڱʧܣ /proc/sys/vm/max_map_count
 		assert(ok);
+		return stack;
+	}
+
+	static void free_stack(void* stack, size_t allocSize)
+	{
+		munmap(stack, allocSize);
+	}
+#endif
+
+	static void start_context(context_yield::context_info* info, context_yield::context_handler handler, void* p)
+	{
+		const size_t allocSize = info->stackSize + info->reserveSize;
 		struct local_ref
 		{
 			context_yield::context_handler handler;
@@ -187,11 +437,45 @@ struct transfer_t
 		});
 		jumpfcontext(&info->nc, info->obj, &ref);
 #endif
+	}
+
+	static context_yield::context_info* make_stack(size_t stackSize)
+	{
+		size_t allocSize = MEM_ALIGN(stackSize + STACK_RESERVED_SPACE_SIZE, STACK_BLOCK_SIZE);
+		void* stack = alloc_stack(allocSize);
+		if (!stack)
+		{
+			return NULL;
+		}
+		//ջջջ۵ĵײ
+		const size_t slotSize = STACK_SLOT_SIZE(allocSize);
+		context_yield::context_info* info = new context_yield::context_info;
+		info->stackTop = (char*)stack + slotSize;
+		info->stackSize = stackSize;
+		info->reserveSize = slotSize - info->stackSize;
+		return info;
+	}
+
+	context_yield::context_info* make_context(size_t stackSize, context_yield::context_handler handler, void* p)
+	{
+		context_yield::context_info* info = make_stack(stackSize);
+		if (info)
+		{
+			start_context(info, handler, p);
+		}
 		return info;
 	}
 
 	void push_yield(context_yield::context_info* info)
 	{
+#if (defined ENABLE_STACK_ARENA) && (defined STACK_ARENA_NO_GUARD_PAGE) && !(defined ENABLE_GROWABLE_STACK)
+		//ûڱҳÿг˿ȸֵֹ
+		if (!check_context(info))
+		{
+			trace_line("\nerror: ", "actor stack overflow");
+			abort();
+		}
+#endif
 #ifdef DISABLE_FLOAT_CONTEXT
 		info->nc = jumpnfcontext(info->nc, NULL).fctx;
 #else
@@ -210,15 +494,124 @@ struct transfer_t
 
 	void delete_context(context_yield::context_info* info)
 	{
+		assert(check_context(info));
 		const size_t s = info->stackSize + info->reserveSize;
-		munmap((char*)info->stackTop - s, s);
+		free_stack((char*)info->stackTop - s, s);
 		delete info;
 	}
 
+	bool check_context(context_yield::context_info* info)
+	{
+#if (defined ENABLE_STACK_ARENA) && (defined STACK_ARENA_NO_GUARD_PAGE) && !(defined ENABLE_GROWABLE_STACK)
+		//ڱҳʱջ׽˿ȸֵд˵ջջ
+		size_t* const stack = (size_t*)((char*)info->stackTop - info->stackSize - info->reserveSize);
+		for (size_t i = 0; i < STACK_CANARY_WORDS; i++)
+		{
+			if (stack_canary(stack, i) != stack[i])
+			{
+				return false;
+			}
+		}
+#endif
+		return true;
+	}
+
 	void decommit_context(context_yield::context_info* info)
 	{
 		const size_t s = info->stackSize + info->reserveSize;
 		madvise((char*)info->stackTop - (s - MEM_PAGE_SIZE), s - 2 * MEM_PAGE_SIZE, MADV_DONTNEED);
 	}
+
+	void release_context(context_yield::context_info* info)
+	{
+		//ջһҳڱ˿ȸҳ黹
+		const size_t s = info->stackSize + info->reserveSize;
+		madvise((char*)info->stackTop - (s - MEM_PAGE_SIZE), s - MEM_PAGE_SIZE, MADV_DONTNEED);
+	}
+
+	bool prefault_context(context_yield::context_info* info, bool touch, bool hugePage, bool lock)
+	{
+		char* const low = (char*)info->stackTop - info->stackSize;
+#ifdef MADV_HUGEPAGE
+		if (hugePage)
+		{
+			madvise(low, info->stackSize, MADV_HUGEPAGE);
+		}
+#endif
+		if (touch)
+		{
+#ifdef MADV_POPULATE_WRITE
+			if (0 != madvise(low, info->stackSize, MADV_POPULATE_WRITE))
+#endif
+			{
+				//ԭֵдأʹõջҳҲɴ
+				for (char* p = (char*)info->stackTop - MEM_PAGE_SIZE; p >= low; p -= MEM_PAGE_SIZE)
+				{
+					*(volatile char*)p = *(volatile char*)p;
+				}
+			}
+		}
+		return !lock || 0 == mlock(low, info->stackSize);
+	}
+
+	void unlock_context(context_yield::context_info* info)
+	{
+		munlock((char*)info->stackTop - info->stackSize, info->stackSize);
+	}
+
+	size_t stack_used_size(context_yield::context_info* info)
+	{
+		//ջԶʹãջҵĵһפҳ϶ã
+		//ջ׵һҳڱҳ˿ȸҳҲɨ裬÷ݴ˹黹ڴʱ˿ȸֵ
+		unsigned char mvec[256];
+		const size_t totalStackSize = info->stackSize + info->reserveSize - MEM_PAGE_SIZE;
+		char* const sb = (char*)info->stackTop - totalStackSize;
+		for (size_t i = 0; i < totalStackSize; i += sizeof(mvec) * MEM_PAGE_SIZE)
+		{
+			const size_t n = std::min(sizeof(mvec) * MEM_PAGE_SIZE, totalStackSize - i);
+			if (0 != mincore(sb + i, n, mvec))
+			{
+				return 0;
+			}
+			for (size_t j = 0; j < n; j += MEM_PAGE_SIZE)
+			{
+				if (mvec[j / MEM_PAGE_SIZE] & 1)
+				{
+					return totalStackSize - i - j;
+				}
+			}
+		}
+		return 0;
+	}
+
+	bool grow_stack(void* faultAddr, void* sp)
+	{
+#ifdef ENABLE_GROWABLE_STACK
+		//źŴеãֻҺmprotect
+		const size_t fault = (size_t)faultAddr;
+		for (size_t i = 0; i < GROWABLE_STACK_MAX_CHUNKS; i++)
+		{
+			const size_t chunk = (size_t)s_growChunks[i].load(std::memory_order_acquire);
+			if (!chunk)
+			{
+				break;
+			}
+			if (fault >= chunk && fault < chunk + GROWABLE_STACK_CHUNK_SIZE)
+			{
+				const size_t slot = chunk + (fault - chunk) / GROWABLE_STACK_SLOT * GROWABLE_STACK_SLOT;
+				const size_t page = fault & (0 - (size_t)MEM_PAGE_SIZE);
+				//۵ڱҳڱջִķҲչ
+				if (page < slot + MEM_PAGE_SIZE || (sp && ((size_t)sp < slot || (size_t)sp >= slot + GROWABLE_STACK_SLOT)))
+				{
+					return false;
+				}
+				const size_t low = page + MEM_PAGE_SIZE >= slot + MEM_PAGE_SIZE + GROWABLE_STACK_STEP ? page + MEM_PAGE_SIZE - GROWABLE_STACK_STEP : slot + MEM_PAGE_SIZE;
+				//ջ֡ҳֱӷʵʹչһֱŵ۶ѿŵĲֱֲ䣬ջʼֻռһӳ
+				return 0 == mprotect((void*)low, slot + GROWABLE_STACK_SLOT - low, PROT_READ | PROT_WRITE);
+			}
+		}
+#endif
+		return false;
+	}
 #endif
 }
\ No newline at end of file
@@ -22,6 +22,37 @@ namespace context_yield
 	void pull_yield(context_info* info);
 	void delete_context(context_info* info);
 	void decommit_context(context_info* info);
+
+	/*!
+	@brief 黹ջڴ(ջҳ)ջݶʧinfoгʱ
+	*/
+	void release_context(context_info* info);
+
+	/*!
+	@brief Ԥύջڴ棬infoջϵ
+	@param touch ҳв״ʹȱҳ
+	@param hugePage ں͸ҳ(linux)ջҳʱЧ
+	@param lock RLIMIT_MEMLOCK
+	@return ʧܷfalse
+	*/
+	bool prefault_context(context_info* info, bool touch, bool hugePage, bool lock);
+
+	/*!
+	@brief prefault_context
+	*/
+	void unlock_context(context_info* info);
+
+	/*!
+	@brief ջˮλջύ(פ)ҳľ룬̵߳
+	*/
+	size_t stack_used_size(context_info* info);
+	bool check_context(context_info* info);
+
+	/*!
+	@brief SIGSEGVеãڿջ(ENABLE_GROWABLE_STACK)δʱչtrueʾִ
+	@param sp ʱջָ룬ͬһջڲչNULL
+	*/
+	bool grow_stack(void* faultAddr, void* sp);
 }
 
 #endif
@@ -274,7 +274,7 @@ void generator::_co_async_next()
 	}
 	else
 	{
-		_strand->post(std::bind([](generator_handle& host)
+		_strand->post_batch(std::bind([](generator_handle& host)
 		{
 			generator* const host_ = host.get();
 			if (host_->__ctx)
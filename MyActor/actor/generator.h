@@ -6553,14 +6553,18 @@ private:
 			}
 			_popWait.pop_front();
 		}
-		for (size_t i = 0; i < ntfNum; i++)
-		{
-			ntfs[i]->invoke(_alloc, co_async_state::co_async_ok);
-		}
-		while (!ntfsEx.empty())
 		{
-			ntfsEx.front()->invoke(_alloc, co_async_state::co_async_ok);
-			ntfsEx.pop_front();
+			//ȴ߷ֲڲͬstrandϣͶݰstrandϲ
+			post_batch_scope batchScope;
+			for (size_t i = 0; i < ntfNum; i++)
+			{
+				ntfs[i]->invoke(_alloc, co_async_state::co_async_ok);
+			}
+			while (!ntfsEx.empty())
+			{
+				ntfsEx.front()->invoke(_alloc, co_async_state::co_async_ok);
+				ntfsEx.pop_front();
+			}
 		}
 		CHECK_EXCEPTION(ntf, co_async_state::co_async_ok);
 	}
@@ -0,0 +1,59 @@
+#include "idle_spin.h"
+
+IdleSpin_::counter::counter()
+:_spinHits(0), _spinMisses(0) {}
+
+void IdleSpin_::counter::reset()
+{
+	_spinHits = 0;
+	_spinMisses = 0;
+}
+
+idle_stats IdleSpin_::counter::get() const
+{
+	idle_stats res;
+	res.spinHits = _spinHits;
+	res.spinMisses = _spinMisses;
+	return res;
+}
+//////////////////////////////////////////////////////////////////////////
+
+IdleSpin_::IdleSpin_(const idle_policy& policy, counter& stats)
+:_policy(policy), _stats(stats), _idleBegin(0), _avgIdleUs(0) {}
+
+bool IdleSpin_::enabled() const
+{
+	return idle_policy::park != _policy.mode;
+}
+
+int IdleSpin_::budget_us() const
+{
+	const int maxUs = _policy.spinUs + _policy.backoffUs;
+	if (idle_policy::adaptive == _policy.mode)
+	{
+		//Ŀмæʱæƽϡ裬ֱӹ
+		if (_avgIdleUs > maxUs)
+		{
+			return 0;
+		}
+		const long long budget = 2 * _avgIdleUs + 1;
+		return budget < maxUs ? (int)budget : maxUs;
+	}
+	return idle_policy::spin == _policy.mode ? maxUs : 0;
+}
+
+void IdleSpin_::sample(long long idleUs)
+{
+	//ʱа޵4룬ܼʱܽϿָæ
+	const long long maxUs = 4 * (_policy.spinUs + _policy.backoffUs);
+	//ָƽȨ1/8
+	_avgIdleUs += ((idleUs < maxUs ? idleUs : maxUs) - _avgIdleUs) / 8;
+}
+
+void IdleSpin_::wakeup()
+{
+	if (idle_policy::adaptive == _policy.mode)
+	{
+		sample(get_tick_us() - _idleBegin);
+	}
+}
\ No newline at end of file
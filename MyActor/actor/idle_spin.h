@@ -0,0 +1,136 @@
+#ifndef __IDLE_SPIN_H
+#define __IDLE_SPIN_H
+
+#include <atomic>
+#include "scattered.h"
+
+//pause˱ܽ׶ÿִеpauseָ
+#ifndef IDLE_PAUSE_MAX
+#define IDLE_PAUSE_MAX 64
+#endif
+
+#ifdef _MSC_VER
+#define CPU_PAUSE() YieldProcessor()
+#elif (__i386__ || __x86_64__)
+#define CPU_PAUSE() __builtin_ia32_pause()
+#elif (__aarch64__ || __arm__)
+#define CPU_PAUSE() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define CPU_PAUSE() __asm__ __volatile__("" ::: "memory")
+#endif
+
+/*!
+@brief ߳̿в
+*/
+struct idle_policy
+{
+	enum idle_mode
+	{
+		park,//
+		spin,//æspinUs΢룬pause˱backoffUs΢룬Ź
+		adaptive//񵽴æʱΪspinUs+backoffUs
+	};
+
+	idle_policy(idle_mode mode_ = park, int spinUs_ = 20, int backoffUs_ = 50)
+	:mode(mode_), spinUs(spinUs_), backoffUs(backoffUs_) {}
+
+	idle_mode mode;
+	int spinUs;
+	int backoffUs;
+};
+
+/*!
+@brief æͳ
+*/
+struct idle_stats
+{
+	long long spinHits;//æڼȵ
+	long long spinMisses;//æȳʱ
+};
+
+/*!
+@brief ߳̿еȴÿ߳һ
+*/
+class IdleSpin_
+{
+public:
+	struct counter
+	{
+		counter();
+		void reset();
+		idle_stats get() const;
+
+		std::atomic<long long> _spinHits;
+		std::atomic<long long> _spinMisses;
+	};
+public:
+	IdleSpin_(const idle_policy& policy, counter& stats);
+public:
+	/*!
+	@brief ǷҪæ
+	*/
+	bool enabled() const;
+
+	/*!
+	@brief ǰæȣpolltrueʾȵ񣬴ʱtrueʱfalse÷
+	*/
+	template <typename Poll>
+	bool spin(Poll&& poll)
+	{
+		const long long begin = get_tick_us();
+		_idleBegin = begin;
+		const int budget = budget_us();
+		if (budget <= 0)
+		{
+			return false;
+		}
+		const long long busyEnd = begin + (budget < _policy.spinUs ? budget : _policy.spinUs);
+		const long long end = begin + budget;
+		int pauses = 1;
+		long long now = begin;
+		do
+		{
+			if (poll())
+			{
+				_stats._spinHits++;
+				sample(get_tick_us() - begin);
+				return true;
+			}
+			if (now < busyEnd)
+			{
+				CPU_PAUSE();
+			}
+			else
+			{
+				//˱ܽ׶μļٶԶе
+				for (int i = 0; i < pauses; i++)
+				{
+					CPU_PAUSE();
+				}
+				if (pauses < IDLE_PAUSE_MAX)
+				{
+					pauses *= 2;
+				}
+			}
+			now = get_tick_us();
+		} while (now < end);
+		_stats._spinMisses++;
+		return false;
+	}
+
+	/*!
+	@brief 󱻻ѣ¼οʱ
+	*/
+	void wakeup();
+private:
+	int budget_us() const;
+	void sample(long long idleUs);
+private:
+	const idle_policy _policy;
+	counter& _stats;
+	long long _idleBegin;
+	long long _avgIdleUs;
+	NONE_COPY(IdleSpin_);
+};
+
+#endif
\ No newline at end of file
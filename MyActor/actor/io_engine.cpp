@@ -4,6 +4,8 @@
 #include "generator.h"
 #include "context_yield.h"
 #include "waitable_timer.h"
+#include "shared_timer.h"
+#include "steal_scheduler.h"
 
 #ifdef ASIO_HANDLER_ALLOCATE_EX
 
@@ -140,13 +142,20 @@ namespace boost
 	}
 }
 
-struct safe_stack_info
+struct SafeStack_
 {
 	const wrap_local_handler_face<void()>* handler = NULL;
 	context_yield::context_info* ctx = NULL;
 };
 
+//ÿ̵߳Ŀаȫջ
+struct safe_stack_pool
+{
+	std::vector<SafeStack_*> idle;
+};
+
 tls_space* io_engine::_tls = NULL;
+std::atomic<long long> io_engine::_safeStackCount(0);
 #if (defined DISABLE_BOOST_TIMER) && (defined ENABLE_GLOBAL_TIMER)
 WaitableTimer_* io_engine::_waitableTimer = NULL;
 #endif
@@ -179,13 +188,25 @@ void io_engine::uninstall()
 #endif
 }
 
-io_engine::io_engine(bool enableTimer, const char* title)
-:io_engine(MEM_POOL_LENGTH, enableTimer, title) {}
+io_engine::io_engine(bool enableTimer, const char* title, engine_mode mode)
+:io_engine(MEM_POOL_LENGTH, enableTimer, title, mode) {}
 
-io_engine::io_engine(size_t poolSize, bool enableTimer, const char* title)
+io_engine::io_engine(size_t poolSize, bool enableTimer, const char* title, engine_mode mode)
 {
 	_opend = false;
+	_numaNodes = 1;
 	_poolSize = poolSize > 4 ? poolSize : 4;
+	_stealScheduler = work_steal == mode ? new StealScheduler_(*this) : NULL;
+	_classQueue = work_steal == mode ? NULL : new StrandClassQueue_();
+	_mode = mode;
+	_shardRound = 0;
+	_threadCount = 0;
+	_retireRequest = 0;
+	if (sharded == mode)
+	{
+		//0Ƭֱʹ_iosstrandͶݺengineϴsocketڵ0߳
+		_shardIos.push_back(&_ios);
+	}
 	_title = title ? title : "io_engine";
 #ifdef WIN32
 	_priority = normal;
@@ -193,7 +214,69 @@ io_engine::io_engine(size_t poolSize, bool enableTimer, const char* title)
 	_priority = idle;
 	_policy = sched_other;
 #endif
-	_strandPool = create_shared_pool_mt<boost_strand, std::mutex>(2 * run_thread::cpu_thread_number(), [](void* p)
+	_strandPool = new_strand_pool();
+	//ÿͨȼһstrandأstrandͬһȼ
+	_classStrandPool[strand_realtime] = new_strand_pool();
+	_classStrandPool[strand_normal] = NULL;
+	_classStrandPool[strand_background] = new_strand_pool();
+#ifdef DISABLE_BOOST_TIMER
+#ifndef ENABLE_GLOBAL_TIMER
+	_waitableTimer = enableTimer ? new WaitableTimer_() : NULL;
+#endif
+#endif
+}
+
+io_engine::~io_engine()
+{
+	assert(!_opend);
+#ifdef DISABLE_BOOST_TIMER
+#ifndef ENABLE_GLOBAL_TIMER
+	delete _waitableTimer;
+#endif
+#elif (defined ENABLE_SHARED_TIMER)
+	//ڷƬio_serviceͷ
+	for (auto& ele : _sharedTimers)
+	{
+		for (SharedTimer_* const timer : ele.second)
+		{
+			delete timer;
+		}
+	}
+#endif
+	delete _strandPool;
+	for (auto& ele : _pinnedStrandPool)
+	{
+		delete ele;
+	}
+	for (auto& ele : _nodeStrandPool)
+	{
+		delete ele;
+	}
+	for (auto& ele : _retiredStrandPool)
+	{
+		delete ele;
+	}
+	for (auto& ele : _classStrandPool)
+	{
+		delete ele;
+	}
+	delete _classQueue;
+	delete _stealScheduler;
+#ifdef ENABLE_STRAND_STATS
+	for (StrandStats_* const ele : _threadStats)
+	{
+		delete ele;
+	}
+#endif
+	for (size_t i = 1; i < _shardIos.size(); i++)
+	{
+		delete _shardIos[i];
+	}
+}
+
+shared_obj_pool<boost_strand>* io_engine::new_strand_pool()
+{
+	return create_shared_pool_mt<boost_strand, std::mutex>(2 * run_thread::cpu_thread_number(), [](void* p)
 	{
 		new(p)boost_strand();
 	}, [](boost_strand* p)->bool
@@ -209,147 +292,372 @@ io_engine::io_engine(size_t poolSize, bool enableTimer, const char* title)
 		}
 		return false;
 	});
-#ifdef DISABLE_BOOST_TIMER
-#ifndef ENABLE_GLOBAL_TIMER
-	_waitableTimer = enableTimer ? new WaitableTimer_() : NULL;
-#endif
-#endif
 }
 
-io_engine::~io_engine()
+void io_engine::run(size_t threads, sched policy)
 {
-	assert(!_opend);
-#ifdef DISABLE_BOOST_TIMER
-#ifndef ENABLE_GLOBAL_TIMER
-	delete _waitableTimer;
-#endif
-#endif
-	delete _strandPool;
+	runGroups(std::vector<size_t>(threads, 0), std::vector<std::vector<int> >(), policy);
 }
 
-void io_engine::run(size_t threads, sched policy)
+void io_engine::runNuma(size_t threadsPerNode, sched policy)
+{
+	std::vector<std::vector<int> > nodeCpus = run_thread::numa_nodes();
+	std::vector<size_t> threadNodes;
+	for (size_t i = 0; i < nodeCpus.size(); i++)
+	{
+		threadNodes.insert(threadNodes.end(), threadsPerNode ? threadsPerNode : nodeCpus[i].size(), i);
+	}
+	runGroups(threadNodes, nodeCpus, policy);
+}
+
+void io_engine::runGroups(const std::vector<size_t>& threadNodes, const std::vector<std::vector<int> >& nodeCpus, sched policy)
 {
-	assert(threads >= 1);
+	const size_t threads = threadNodes.size();
+	assert(threads >= 1 && threads <= IO_ENGINE_MAX_THREADS);
 	std::lock_guard<std::mutex> lg(_runMutex);
 	if (!_opend)
 	{
-		_opend = true;
 		_runCount = 0;
+		_idleStats.reset();
+		_safeStackStats.reset();
 		holdWork();
 		_handleList.resize(threads);
+		_threadNode = threadNodes;
+		//Ԥ߳resize߳ʱ·䣬߳̿ɼȡ
+		_handleList.reserve(IO_ENGINE_MAX_THREADS);
+		_threadNode.reserve(IO_ENGINE_MAX_THREADS);
+		_shardIos.reserve(IO_ENGINE_MAX_THREADS);
+		_pinnedStrandPool.reserve(IO_ENGINE_MAX_THREADS);
+		_nodeCpus = nodeCpus;
+		_numaNodes = nodeCpus.empty() ? 1 : nodeCpus.size();
 #ifdef __linux__
 		_policy = policy;
 #endif
-		size_t rc = 0;
-		std::shared_ptr<std::mutex> blockMutex = std::make_shared<std::mutex>();
-		std::shared_ptr<std::condition_variable> blockConVar = std::make_shared<std::condition_variable>();
-		std::unique_lock<std::mutex> ul(*blockMutex);
+		if (sharded == _mode)
+		{
+			while (_shardIos.size() < threads)
+			{
+				_shardIos.push_back(new boost::asio::io_service(1));
+			}
+			//Ƭڵ0Ƭʱͷ
+			for (size_t i = 1; i < threads; i++)
+			{
+				_shardIos[i]->dispatch(boost::asio::io_service_work_started());
+			}
+		}
+		if (_stealScheduler || sharded == _mode)
+		{
+			if (_stealScheduler)
+			{
+				_stealScheduler->open(_numaNodes);
+			}
+			for (size_t i = 0; i < threads; i++)
+			{
+				openWorker(i);
+			}
+			//ÿڵһstrandأstrandʼͬһڵȣnext tickڴҲڸýڵ
+			while (_nodeStrandPool.size() < _numaNodes)
+			{
+				_nodeStrandPool.push_back(new_strand_pool());
+			}
+		}
+		//̱߳ƬstrandؾٱУƬģʽ´strandݴ˾Ƿ䵽Ƭ
+		_opend = true;
+		std::vector<size_t> slots(threads);
 		for (size_t i = 0; i < threads; i++)
 		{
-			run_thread* newThread = new run_thread([&, i]
+			slots[i] = i;
+		}
+		startThreads(slots);
+	}
+}
+
+void io_engine::startThreads(const std::vector<size_t>& slots)
+{
+	const size_t threads = slots.size();
+	size_t rc = 0;
+	std::shared_ptr<std::mutex> blockMutex = std::make_shared<std::mutex>();
+	std::shared_ptr<std::condition_variable> blockConVar = std::make_shared<std::condition_variable>();
+	std::unique_lock<std::mutex> ul(*blockMutex);
+	for (const size_t i : slots)
+	{
+		run_thread* newThread = new run_thread([&, i]
+		{
+			try
 			{
-				try
 				{
+					run_thread::set_current_thread_name(_title.c_str());
+					if (!_nodeCpus.empty())
 					{
-						run_thread::set_current_thread_name(_title.c_str());
+						//Ȱ󶨽ڵٷ߳ڴ棬֤״ηڱڵ
+						run_thread::set_current_affinity(_nodeCpus[_threadNode[i]]);
+					}
 #ifdef WIN32
-						SetThreadPriority(GetCurrentThread(), _priority);
-						DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &_handleList[i], 0, FALSE, DUPLICATE_SAME_ACCESS);
+					SetThreadPriority(GetCurrentThread(), _priority);
+					DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(), &_handleList[i], 0, FALSE, DUPLICATE_SAME_ACCESS);
 #elif __linux__
-						pthread_attr_init(&_handleList[i]);
-						pthread_attr_setschedpolicy(&_handleList[i], _policy);
-						if (0 == i)
-						{
-							struct sched_param pm;
-							int rs = pthread_attr_getschedparam(&_handleList[i], &pm);
-							_priority = (priority)pm.sched_priority;
-						}
-#endif
-						auto lockMutex = blockMutex;
-						auto lockConVar = blockConVar;
-						std::unique_lock<std::mutex> ul(*lockMutex);
-						if (threads == ++rc)
-						{
-							lockConVar->notify_all();
-						}
-						else
-						{
-							lockConVar->wait(ul);
-						}
+					pthread_attr_init(&_handleList[i]);
+					pthread_attr_setschedpolicy(&_handleList[i], _policy);
+					if (0 == i)
+					{
+						struct sched_param pm;
+						int rs = pthread_attr_getschedparam(&_handleList[i], &pm);
+						_priority = (priority)pm.sched_priority;
 					}
-					context_yield::convert_thread_to_fiber();
-					__space_align void* tlsBuff[64] = { 0 };
-					_tls->set_space(tlsBuff);
-					my_actor::tls_init();
-					generator::tls_init();
-#ifdef ASIO_HANDLER_ALLOCATE_EX
-					void* asioAll[5] =
+#endif
+					auto lockMutex = blockMutex;
+					auto lockConVar = blockConVar;
+					std::unique_lock<std::mutex> ul(*lockMutex);
+					if (threads == ++rc)
 					{
-						new handler_alloc1(_poolSize),
-						new handler_alloc2(_poolSize / 2),
-						new handler_alloc3(_poolSize / 3),
-						new handler_alloc4(_poolSize / 4),
-						new handler_reu_alloc()
-					};
-					tlsBuff[ASIO_HANDLER_ALLOC_EX_INDEX] = asioAll;
-#endif
-					safe_stack_info safeStack;
-					tlsBuff[ACTOR_SAFE_STACK_INDEX] = &safeStack;
-					safeStack.ctx = context_yield::make_context(MAX_STACKSIZE, [](context_yield::context_info* ctx, void* param)
+						lockConVar->notify_all();
+					}
+					else
 					{
-						while (true)
-						{
-							context_yield::push_yield(ctx);
-							safe_stack_info* const safeStack = (safe_stack_info*)param;
-							CHECK_EXCEPTION(*safeStack->handler);
-						}
-					}, &safeStack);
-#if (__linux__ && ENABLE_DUMP_STACK)
-					__space_align char dumpStack[8 kB];
-					my_actor::dump_segmentation_fault(dumpStack, sizeof(dumpStack));
-#endif
-					tlsBuff[IO_ENGINE_INDEX] = this;
-					_runCount += _ios.run();
-#if (__linux__ && ENABLE_DUMP_STACK)
-					my_actor::undump_segmentation_fault();
-#endif
-					context_yield::delete_context(safeStack.ctx);
+						lockConVar->wait(ul);
+					}
+				}
+				context_yield::convert_thread_to_fiber();
+				__space_align void* tlsBuff[64] = { 0 };
+				_tls->set_space(tlsBuff);
+				my_actor::tls_init();
+				generator::tls_init();
 #ifdef ASIO_HANDLER_ALLOCATE_EX
-					delete (handler_alloc1*)asioAll[0];
-					delete (handler_alloc2*)asioAll[1];
-					delete (handler_alloc3*)asioAll[2];
-					delete (handler_alloc4*)asioAll[3];
-					delete (handler_reu_alloc*)asioAll[4];
-#endif
-					generator::tls_uninit();
-					my_actor::tls_uninit();
-					_tls->set_space(NULL);
-					context_yield::convert_fiber_to_thread();
+				void* asioAll[5] =
+				{
+					new handler_alloc1(_poolSize),
+					new handler_alloc2(_poolSize / 2),
+					new handler_alloc3(_poolSize / 3),
+					new handler_alloc4(_poolSize / 4),
+					new handler_reu_alloc()
+				};
+				tlsBuff[ASIO_HANDLER_ALLOC_EX_INDEX] = asioAll;
+#endif
+				safe_stack_pool safeStackPool;
+				tlsBuff[ACTOR_SAFE_STACK_INDEX] = &safeStackPool;
+				pushSafeStack(popSafeStack());
+#if (__linux__ && (ENABLE_DUMP_STACK || (defined ENABLE_GROWABLE_STACK)))
+				__space_align char dumpStack[8 kB];
+				my_actor::dump_segmentation_fault(dumpStack, sizeof(dumpStack));
+#endif
+				tlsBuff[IO_ENGINE_INDEX] = this;
+				tlsBuff[NUMA_NODE_INDEX] = (void*)_threadNode[i];
+#ifdef ENABLE_STRAND_STATS
+				StrandStats_* const threadStats = popThreadStats();
+				tlsBuff[STRAND_STATS_INDEX] = threadStats;
+#endif
+				IdleSpin_ idleSpin(_idlePolicy, _idleStats);
+				bool retired = false;
+				if (_stealScheduler)
+				{
+					_runCount += _stealScheduler->run(i, idleSpin);
+					retired = _stealScheduler->get_worker(i)->_retired;
+				}
+				else if (sharded == _mode)
+				{
+					_runCount += runShard(i, idleSpin);
 				}
-				catch (boost::exception&)
+				else
 				{
-					trace_line("\nerror: ", "boost::exception");
-					exit(2);
+					_runCount += runAsio(_ios, idleSpin, &retired);
 				}
-				catch (std::exception&)
+#if (__linux__ && (ENABLE_DUMP_STACK || (defined ENABLE_GROWABLE_STACK)))
+				my_actor::undump_segmentation_fault();
+#endif
+				for (SafeStack_* const ele : safeStackPool.idle)
 				{
-					trace_line("\nerror: ", "std::exception");
-					exit(3);
+					context_yield::delete_context(ele->ctx);
+					delete ele;
+					_safeStackCount--;
 				}
-				catch (std::shared_ptr<std::string>& msg)
+				tlsBuff[ACTOR_SAFE_STACK_INDEX] = NULL;
+#ifdef ENABLE_STRAND_STATS
+				tlsBuff[STRAND_STATS_INDEX] = NULL;
+				pushThreadStats(threadStats);
+#endif
+#ifdef ASIO_HANDLER_ALLOCATE_EX
+				delete (handler_alloc1*)asioAll[0];
+				delete (handler_alloc2*)asioAll[1];
+				delete (handler_alloc3*)asioAll[2];
+				delete (handler_alloc4*)asioAll[3];
+				delete (handler_reu_alloc*)asioAll[4];
+#endif
+				generator::tls_uninit();
+				my_actor::tls_uninit();
+				_tls->set_space(NULL);
+				context_yield::convert_fiber_to_thread();
+				if (retired)
 				{
-					trace_line("\nerror: ", *msg);
-					exit(4);
+					//ǼǺresizeձ߳
+					std::lock_guard<std::mutex> lg(_ctrlMutex);
+					_retiredThreads.push_back(std::make_pair(i, run_thread::this_thread_id()));
+					_retireVar.notify_all();
 				}
-				catch (...)
+			}
+			catch (boost::exception&)
+			{
+				trace_line("\nerror: ", "boost::exception");
+				exit(2);
+			}
+			catch (std::exception&)
+			{
+				trace_line("\nerror: ", "std::exception");
+				exit(3);
+			}
+			catch (std::shared_ptr<std::string>& msg)
+			{
+				trace_line("\nerror: ", *msg);
+				exit(4);
+			}
+			catch (...)
+			{
+				exit(-1);
+			}
+		});
+		_ctrlMutex.lock();
+		_threadsID.insert(newThread->get_id());
+		_threadCount = _threadsID.size();
+		_ctrlMutex.unlock();
+		_runThreads.push_back(newThread);
+	}
+	blockConVar->wait(ul);
+}
+
+bool io_engine::resize(size_t threads)
+{
+	assert(threads >= 1 && threads <= IO_ENGINE_MAX_THREADS);
+	std::lock_guard<std::mutex> lg(_runMutex);
+	if (!_opend)
+	{
+		return false;
+	}
+	assert(!runningInThisIos());
+	const size_t current = _threadCount;
+	if (threads > current)
+	{
+		std::vector<size_t> slots;
+		while (current + slots.size() < threads)
+		{
+			slots.push_back(openSlot());
+		}
+		startThreads(slots);
+	}
+	else if (threads < current)
+	{
+		if (sharded == _mode)
+		{
+			return false;
+		}
+		if (_stealScheduler)
+		{
+			//е߳ʼǰcurrentĩβ̣߳ÿڵٱһ̴߳ڵע
+			for (size_t node = 0; node < _numaNodes; node++)
+			{
+				if (_threadNode.begin() + threads == std::find(_threadNode.begin(), _threadNode.begin() + threads, node))
 				{
-					exit(-1);
+					return false;
 				}
+			}
+			for (size_t i = threads; i < current; i++)
+			{
+				//strandתͬڵ㱣ĵһ߳
+				const size_t forward = std::find(_threadNode.begin(), _threadNode.begin() + threads, _threadNode[i]) - _threadNode.begin();
+				_stealScheduler->retire(i, forward);
+			}
+		}
+		else
+		{
+			//̶߳Եȣÿrun_one/poll_oneǰȿ߳˳Ͷݿ߳
+			_retireRequest += current - threads;
+			for (size_t i = threads; i < current; i++)
+			{
+				_ios.post([]{});
+			}
+		}
+		std::vector<std::pair<size_t, run_thread::thread_id> > retiredThreads;
+		{
+			std::unique_lock<std::mutex> ul(_ctrlMutex);
+			while (_retiredThreads.size() < current - threads)
+			{
+				_retireVar.wait(ul);
+			}
+			retiredThreads.swap(_retiredThreads);
+			for (auto& ele : retiredThreads)
+			{
+				_threadsID.erase(ele.second);
+#ifdef WIN32
+				CloseHandle(_handleList[ele.first]);
+				_handleList[ele.first] = NULL;
+#endif
+			}
+			_threadCount = _threadsID.size();
+		}
+		for (auto& ele : retiredThreads)
+		{
+			auto it = std::find_if(_runThreads.begin(), _runThreads.end(), [&](run_thread* th)->bool
+			{
+				return ele.second == th->get_id();
 			});
-			_threadsID.insert(newThread->get_id());
-			_runThreads.push_back(newThread);
+			assert(_runThreads.end() != it);
+			(*it)->join();
+			delete *it;
+			_runThreads.erase(it);
+			_freeSlots.push_back(ele.first);
+		}
+	}
+	return true;
+}
+
+size_t io_engine::openSlot()
+{
+	size_t slot = _threadNode.size();
+	if (!_freeSlots.empty())
+	{
+		//ȸСĿţwork_stealģʽе߳ʼǰioThreads()
+		auto it = std::min_element(_freeSlots.begin(), _freeSlots.end());
+		slot = *it;
+		_freeSlots.erase(it);
+#ifdef __linux__
+		pthread_attr_destroy(&_handleList[slot]);
+#endif
+	}
+	else
+	{
+		assert(slot < IO_ENGINE_MAX_THREADS);
+		//ڸڵתԤռ䣬׷Ӳƶ߳ڶȡԪ
+		_ctrlMutex.lock();
+		_threadNode.push_back(slot % _numaNodes);
+		_handleList.resize(slot + 1);
+		_ctrlMutex.unlock();
+		if (sharded == _mode)
+		{
+			if (_shardIos.size() <= slot)
+			{
+				_shardIos.push_back(new boost::asio::io_service(1));
+			}
+			//ڵ0Ƭʱͷ
+			_shardIos[slot]->dispatch(boost::asio::io_service_work_started());
 		}
-		blockConVar->wait(ul);
+	}
+	if (_stealScheduler || sharded == _mode)
+	{
+		openWorker(slot);
+	}
+	return slot;
+}
+
+void io_engine::openWorker(size_t slot)
+{
+	//ÿ߳һstrandأstrandʼհͬһ߳
+	while (_pinnedStrandPool.size() <= slot)
+	{
+		_pinnedStrandPool.push_back(new_strand_pool());
+	}
+	if (_stealScheduler && _stealScheduler->renew(slot, _threadNode[slot]))
+	{
+		//strand԰۵Ĺϣһ³
+		_retiredStrandPool.push_back(_pinnedStrandPool[slot]);
+		_pinnedStrandPool[slot] = new_strand_pool();
 	}
 }
 
@@ -366,8 +674,25 @@ void io_engine::stop()
 			delete _runThreads.front();
 			_runThreads.pop_front();
 		}
+		if (_stealScheduler)
+		{
+			_stealScheduler->close();
+		}
 		_ios.reset();
+		for (size_t i = 1; i < _shardIos.size(); i++)
+		{
+			_shardIos[i]->reset();
+		}
+		_ctrlMutex.lock();
 		_threadsID.clear();
+		_threadCount = 0;
+		_retiredThreads.clear();
+		_retireRequest = 0;
+		_threadNode.clear();
+		_ctrlMutex.unlock();
+		_freeSlots.clear();
+		_nodeCpus.clear();
+		_numaNodes = 1;
 		_ctrlMutex.lock();
 		for (auto& ele : _handleList)
 		{
@@ -386,13 +711,120 @@ void io_engine::stop()
 bool io_engine::runningInThisIos()
 {
 	assert(_opend);
+	std::lock_guard<std::mutex> lg(_ctrlMutex);
 	return _threadsID.find(run_thread::this_thread_id()) != _threadsID.end();
 }
 
 size_t io_engine::ioThreads()
 {
 	assert(_opend);
-	return _threadsID.size();
+	return _threadCount;
+}
+
+size_t io_engine::numaNodes()
+{
+	assert(_opend);
+	return _numaNodes;
+}
+
+size_t io_engine::threadNode(size_t threadIndex)
+{
+	assert(_opend);
+	assert(threadIndex < _threadNode.size());
+	return _threadNode[threadIndex];
+}
+
+size_t io_engine::runAsio(boost::asio::io_service& ios, IdleSpin_& idleSpin, bool* retired)
+{
+	if (!idleSpin.enabled() && !retired)
+	{
+		return ios.run();
+	}
+	size_t count = 0;
+	while (true)
+	{
+		if (retired && _retireRequest && takeRetire())
+		{
+			*retired = true;
+			break;
+		}
+		size_t n = 0;
+		if (idleSpin.enabled())
+		{
+			n = ios.poll_one();
+			if (n || idleSpin.spin([&]()->bool
+			{
+				return 0 != (n = ios.poll_one());
+			}))
+			{
+				count += n;
+				continue;
+			}
+		}
+		//æȳʱio_serviceϵȴ
+		n = ios.run_one();
+		idleSpin.wakeup();
+		if (!n)
+		{
+			break;
+		}
+		count += n;
+	}
+	return count;
+}
+
+bool io_engine::takeRetire()
+{
+	size_t n = _retireRequest;
+	while (n && !_retireRequest.compare_exchange_weak(n, n - 1)) {}
+	return 0 != n;
+}
+
+size_t io_engine::runShard(size_t index, IdleSpin_& idleSpin)
+{
+	const size_t count = runAsio(*_shardIos[index], idleSpin);
+	if (0 == index)
+	{
+		//strandڵ0Ƭϣ0Ƭ˵
+		for (size_t i = 1; i < _threadNode.size(); i++)
+		{
+			_shardIos[i]->dispatch(boost::asio::io_service_work_finished());
+		}
+	}
+	return count;
+}
+
+size_t io_engine::nextShard(size_t numaNode)
+{
+	const size_t threads = _threadNode.size();
+	assert(threads);
+	const size_t round = _shardRound++;
+	if ((size_t)-1 != numaNode)
+	{
+		//ڸýڵ߳ת
+		for (size_t i = 0; i < threads; i++)
+		{
+			const size_t shard = (round + i) % threads;
+			if (numaNode == _threadNode[shard])
+			{
+				return shard;
+			}
+		}
+	}
+	return round % threads;
+}
+
+boost::asio::io_service& io_engine::shardService(size_t threadIndex)
+{
+	assert(_opend);
+	assert(threadIndex < _threadNode.size());
+	return sharded == _mode ? *_shardIos[threadIndex] : _ios;
+}
+
+size_t io_engine::classQueueDepth(strand_class cls)
+{
+	assert(cls < strand_class_num);
+	return _stealScheduler ? _stealScheduler->class_depth(cls) : _classQueue->depth(cls);
 }
 
 bool io_engine::ioIdeal(int i)
@@ -482,15 +914,145 @@ void io_engine::releaseWork()
 	_ios.dispatch(boost::asio::io_service_work_finished());
 }
 
+SafeStack_* io_engine::popSafeStack()
+{
+	safe_stack_pool* const pool = (safe_stack_pool*)getTlsValue(ACTOR_SAFE_STACK_INDEX);
+	if (!pool->idle.empty())
+	{
+		SafeStack_* const safeStack = pool->idle.back();
+		pool->idle.pop_back();
+		return safeStack;
+	}
+	SafeStack_* const safeStack = new SafeStack_;
+	safeStack->ctx = context_yield::make_context(MAX_STACKSIZE, [](context_yield::context_info* ctx, void* param)
+	{
+		while (true)
+		{
+			context_yield::push_yield(ctx);
+			SafeStack_* const safeStack = (SafeStack_*)param;
+			CHECK_EXCEPTION(*safeStack->handler);
+		}
+	}, safeStack);
+	if (!safeStack->ctx)
+	{
+		delete safeStack;
+		error_trace_line("stack memory exhaustion");
+		throw my_actor::stack_exhaustion_exception();
+	}
+	_safeStackCount++;
+	return safeStack;
+}
+
+void io_engine::pushSafeStack(SafeStack_* safeStack)
+{
+	assert(!safeStack->handler);
+	//ActorڴջϹָ̻߳ջ黹ǰ߳
+	safe_stack_pool* const pool = (safe_stack_pool*)getTlsValue(ACTOR_SAFE_STACK_INDEX);
+	if (pool->idle.size() < SAFE_STACK_POOL_SIZE)
+	{
+		pool->idle.push_back(safeStack);
+	}
+	else
+	{
+		context_yield::delete_context(safeStack->ctx);
+		delete safeStack;
+		_safeStackCount--;
+	}
+}
+
+void io_engine::recordBlock(long long us)
+{
+	long long maxTime = _safeStackStats._maxBlockTime;
+	while (us > maxTime && !_safeStackStats._maxBlockTime.compare_exchange_weak(maxTime, us)) {}
+}
+
+#if (defined ENABLE_SHARED_TIMER) && !(defined DISABLE_BOOST_TIMER)
+SharedTimer_* io_engine::sharedTimer(boost::asio::io_service& ios, const void* key)
+{
+	std::lock_guard<std::mutex> lg(_sharedTimerMutex);
+	std::vector<SharedTimer_*>* stripes = NULL;
+	for (auto& ele : _sharedTimers)
+	{
+		if (&ios == ele.first)
+		{
+			stripes = &ele.second;
+			break;
+		}
+	}
+	if (!stripes)
+	{
+		//Ƭֻһ̣߳һݣ̹߳õio_serviceֳɼݣstrandʱͬһ
+		const bool isShard = _shardIos.end() != std::find(_shardIos.begin(), _shardIos.end(), &ios);
+		_sharedTimers.push_back(std::make_pair(&ios, std::vector<SharedTimer_*>()));
+		stripes = &_sharedTimers.back().second;
+		for (size_t i = isShard ? 1 : SHARED_TIMER_STRIPES; i > 0; i--)
+		{
+			stripes->push_back(new SharedTimer_(ios));
+		}
+	}
+	return (*stripes)[address_hash(key) % stripes->size()];
+}
+#endif
+
 void io_engine::switchInvoke(const wrap_local_handler_face<void()>& handler)
 {
-	safe_stack_info* si = (safe_stack_info*)getTlsValue(ACTOR_SAFE_STACK_INDEX);
-	assert(!si->handler);
-	si->handler = &handler;
-	context_yield::pull_yield(si->ctx);
-	si->handler = NULL;
+	SafeStack_* const safeStack = popSafeStack();
+	safeStack->handler = &handler;
+	const long long beginTick = get_tick_us();
+	context_yield::pull_yield(safeStack->ctx);
+	const long long us = get_tick_us() - beginTick;
+	safeStack->handler = NULL;
+	pushSafeStack(safeStack);
+	_safeStackStats._safeCount++;
+	_safeStackStats._safeTime += us;
+	recordBlock(us);
 }
 
+void io_engine::deepInvoke(const wrap_local_handler_face<void()>& handler, context_yield::context_info* hostCtx)
+{
+	SafeStack_* const safeStack = popSafeStack();
+	safeStack->handler = &handler;
+	const long long beginTick = get_tick_us();
+#ifdef WIN32
+	//fiberActorָʱinfo->objִڼָȫջfiber
+	void* const hostObj = hostCtx->obj;
+	hostCtx->obj = safeStack->ctx->obj;
+#endif
+	context_yield::pull_yield(safeStack->ctx);
+#ifdef WIN32
+	hostCtx->obj = hostObj;
+#endif
+	safeStack->handler = NULL;
+	pushSafeStack(safeStack);
+	_safeStackStats._deepCount++;
+	_safeStackStats._deepTime += get_tick_us() - beginTick;
+}
+
+void io_engine::recordThreadStack(long long us)
+{
+	_safeStackStats._threadCount++;
+	_safeStackStats._threadTime += us;
+	recordBlock(us);
+}
+
+safe_stack_stats io_engine::safeStackStats()
+{
+	safe_stack_stats res = _safeStackStats.get();
+	res.stackCount = _safeStackCount;
+	return res;
+}
+
+#ifdef DISABLE_BOOST_TIMER
+std::vector<waitable_timer_stats> io_engine::waitableTimerStats()
+{
+	if (_waitableTimer)
+	{
+		return _waitableTimer->getStats();
+	}
+	return std::vector<waitable_timer_stats>();
+}
+#endif
+
 void io_engine::runPriority(priority pri)
 {
 	std::lock_guard<std::mutex> lg(_ctrlMutex);
@@ -523,6 +1085,85 @@ long long io_engine::getRunCount()
 	return _runCount;
 }
 
+void io_engine::idlePolicy(const idle_policy& policy)
+{
+	_idlePolicy = policy;
+}
+
+idle_stats io_engine::idleStats()
+{
+	return _idleStats.get();
+}
+
+io_engine::safe_stack_counter::safe_stack_counter()
+:_safeCount(0), _safeTime(0), _deepCount(0), _deepTime(0), _threadCount(0), _threadTime(0), _maxBlockTime(0) {}
+
+void io_engine::safe_stack_counter::reset()
+{
+	_safeCount = 0;
+	_safeTime = 0;
+	_deepCount = 0;
+	_deepTime = 0;
+	_threadCount = 0;
+	_threadTime = 0;
+	_maxBlockTime = 0;
+}
+
+safe_stack_stats io_engine::safe_stack_counter::get() const
+{
+	safe_stack_stats res;
+	res.safeCount = _safeCount;
+	res.safeTime = _safeTime;
+	res.deepCount = _deepCount;
+	res.deepTime = _deepTime;
+	res.threadCount = _threadCount;
+	res.threadTime = _threadTime;
+	res.maxBlockTime = _maxBlockTime;
+	res.stackCount = 0;
+	return res;
+}
+
+#ifdef ENABLE_STRAND_STATS
+strand_stats io_engine::strandStats(bool reset)
+{
+	strand_stats res;
+	std::lock_guard<std::mutex> lg(_statsMutex);
+	for (StrandStats_* const ele : _threadStats)
+	{
+		strand_stats stats = ele->snapshot(reset);
+		res.queueWait.merge(stats.queueWait);
+		res.runTime.merge(stats.runTime);
+		res.roundTicks.merge(stats.roundTicks);
+	}
+	return res;
+}
+
+StrandStats_* io_engine::popThreadStats()
+{
+	std::lock_guard<std::mutex> lg(_statsMutex);
+	if (!_freeThreadStats.empty())
+	{
+		StrandStats_* const res = _freeThreadStats.back();
+		_freeThreadStats.pop_back();
+		return res;
+	}
+	StrandStats_* const res = new StrandStats_();
+	_threadStats.push_back(res);
+	return res;
+}
+
+void io_engine::pushThreadStats(StrandStats_* stats)
+{
+	std::lock_guard<std::mutex> lg(_statsMutex);
+	_freeThreadStats.push_back(stats);
+}
+#endif
+
+io_engine::engine_mode io_engine::engineMode()
+{
+	return _mode;
+}
+
 const std::set<run_thread::thread_id>& io_engine::threadsID()
 {
 	return _threadsID;
@@ -548,6 +1189,16 @@ io_engine* io_engine::currentEngine()
 	return NULL;
 }
 
+size_t io_engine::currentNode()
+{
+	void** buf = getTlsValueBuff();
+	if (buf)
+	{
+		return (size_t)buf[NUMA_NODE_INDEX];
+	}
+	return 0;
+}
+
 void io_engine::setTlsBuff(void** buf)
 {
 	_tls->set_space(buf);
@@ -584,6 +1235,18 @@ void** io_engine::getTlsValueBuff()
 {
 	return _tls->get_space();
 }
+
+long long io_engine::loopTickUs()
+{
+#ifdef ENABLE_LOOP_TICK
+	void** const tlsBuff = getTlsValueBuff();
+	if (tlsBuff && tlsBuff[LOOP_TICK_INDEX])
+	{
+		return *(long long*)tlsBuff[LOOP_TICK_INDEX];
+	}
+#endif
+	return get_tick_us();
+}
 //////////////////////////////////////////////////////////////////////////
 
 io_work::io_work(io_engine& ios)
@@ -10,24 +10,83 @@
 #include <vector>
 #include "scattered.h"
 #include "strand_ex.h"
+#include "idle_spin.h"
+#include "strand_stats.h"
 #include "mem_pool.h"
 #include "run_thread.h"
 #include "lambda_ref.h"
+#include "context_yield.h"
+
+//߳ޣ߳ʱ̱߳·
+#ifndef IO_ENGINE_MAX_THREADS
+#define IO_ENGINE_MAX_THREADS 256
+#endif
+
+//ÿ̱߳ĿаȫջĹ黹ʱͷ
+#ifndef SAFE_STACK_POOL_SIZE
+#define SAFE_STACK_POOL_SIZE 4
+#endif
+
+/*!
+@brief ջͳƣʱ䵥λ΢
+*/
+struct safe_stack_stats
+{
+	long long safeCount;//run_in_safe_stack
+	long long safeTime;//run_in_safe_stackۼִʱ䣬ڼ߳
+	long long deepCount;//run_in_deep_stack
+	long long deepTime;//run_in_deep_stackۼʱ䣬йȴʱ
+	long long threadCount;//run_in_thread_stack
+	long long threadTime;//run_in_thread_stackۼִʱ䣬ڼ߳
+	long long maxBlockTime;//run_in_safe_stack/run_in_thread_stack̵߳ʱ
+	long long stackCount;//ǰѴİȫջ(ʹõ)
+};
+
+/*!
+@brief waitable_timerƬͳ(DISABLE_BOOST_TIMERʹ)ʱ䵥λ΢
+*/
+struct waitable_timer_stats
+{
+	size_t events;//ǰȴĶʱ
+	long long appendCount;//ۼƵǼǴ
+	long long fireCount;//ۼƵڴ
+	long long wakeCount;//ʱ̻߳Ѵ
+	long long maxBatch;//λѵڵ
+	long long maxLate;//ʱ޵ӳ
+	long long maxHold;//λѴڶеʱ(ڼ䣬ص)
+};
 
 class my_actor;
 class boost_strand;
+class StealScheduler_;
+struct SafeStack_;
 #ifdef DISABLE_BOOST_TIMER
 class WaitableTimer_;
 class WaitableTimerEvent_;
+#elif (defined ENABLE_SHARED_TIMER)
+class SharedTimer_;
+class SharedTimerEvent_;
 #endif
 
 class io_engine
 {
 	friend boost_strand;
+	friend StrandEx_;
 #ifdef DISABLE_BOOST_TIMER
 	friend WaitableTimerEvent_;
+#elif (defined ENABLE_SHARED_TIMER)
+	friend SharedTimerEvent_;
 #endif
 public:
+	/*!
+	@brief ģʽ
+	*/
+	enum engine_mode
+	{
+		asio_strand,//strandasio io_serviceͳһе
+		work_steal,//ÿ̳߳strandУ̴߳߳ȡ
+		sharded//ÿ߳һio_service(reactor)strandsocket̶Ƭִ߳
+	};
 #ifdef WIN32
 	enum priority
 	{
@@ -66,8 +125,8 @@ public:
 	};
 #endif
 public:
-	io_engine(bool enableTimer = true, const char* title = NULL);
-	io_engine(size_t poolSize, bool enableTimer = true, const char* title = NULL);
+	io_engine(bool enableTimer = true, const char* title = NULL, engine_mode mode = asio_strand);
+	io_engine(size_t poolSize, bool enableTimer = true, const char* title = NULL, engine_mode mode = asio_strand);
 	~io_engine();
 public:
 	/*!
@@ -77,6 +136,23 @@ public:
 	*/
 	void run(size_t threads = 1, sched policy = sched_other);
 
+	/*!
+	@brief NUMAڵ鿪ʼеÿڵһ̲߳󶨵ýڵĴϣ
+	@param threadsPerNode ÿڵ߳0ʾڵ㴦ͬ
+	@param policy ̵߳Ȳ(linuxЧwinº)
+	*/
+	void runNuma(size_t threadsPerNode = 0, sched policy = sched_other);
+
+	/*!
+	@brief е߳߳run߳ͬʼ߳̿к˳ɺ󷵻أ
+	asio_strandģʽ߳ȡwork_stealģʽ߳(strandתͬڵ㱣һ̣߳
+	֮һֱڸִ߳Уֱԭŵ߳)
+	shardedģʽ·Ƭ̶strandsocketֻ߳
+	@param threads µ߳(1 ~ IO_ENGINE_MAX_THREADS)
+	@return δСshardedģʽ̻߳ĳڵ㽫ʣ߳ʱfalse
+	*/
+	bool resize(size_t threads);
+
 	/*!
 	@brief ȴʱ
 	*/
@@ -92,6 +168,44 @@ public:
 	*/
 	size_t ioThreads();
 
+	/*!
+	@brief ̷߳(NUMAڵ)run()ʱΪ1
+	*/
+	size_t numaNodes();
+
+	/*!
+	@brief threadIndex߳ڵĽڵ
+	*/
+	size_t threadNode(size_t threadIndex);
+
+	/*!
+	@brief threadIndex̵߳io_service(shardedģʽÿ߳һģʽ¾Ϊͬһ)
+	*/
+	boost::asio::io_service& shardService(size_t threadIndex);
+
+	/*!
+	@brief ĳȼȴȵstrand(asio_strandģʽֻڴͨȼstrandͳ)
+	*/
+	size_t classQueueDepth(strand_class cls);
+
+	/*!
+	@brief õ߳̿вԣ´runʱЧ
+	*/
+	void idlePolicy(const idle_policy& policy);
+
+	/*!
+	@brief ȡrunĿæͳ
+	*/
+	idle_stats idleStats();
+
+#ifdef ENABLE_STRAND_STATS
+	/*!
+	@brief ȡstrandܵĵͳƣ̵߳(̷ֱ߳¼ȡʱϲ)
+	@param reset ȡ
+	*/
+	strand_stats strandStats(bool reset = false);
+#endif
+
 	/*!
 	@brief ȴ
 	*/
@@ -131,7 +245,12 @@ public:
 	long long getRunCount();
 
 	/*!
-	@brief ߳ID
+	@brief ģʽ
+	*/
+	engine_mode engineMode();
+
+	/*!
+	@brief ߳ID(resizeڼ伯ϻ仯Ҫresize)
 	*/
 	const std::set<run_thread::thread_id>& threadsID();
 
@@ -146,15 +265,43 @@ public:
 	operator boost::asio::io_service& () const;
 
 	/*!
-	@brief лһȫջִ
+	@brief ȡrunĴջͳ
+	*/
+	safe_stack_stats safeStackStats();
+
+#ifdef DISABLE_BOOST_TIMER
+	/*!
+	@brief ȡwaitable_timerƬͳ(ENABLE_GLOBAL_TIMERΪȫֶʱ)δöʱʱΪ
+	*/
+	std::vector<waitable_timer_stats> waitableTimerStats();
+#endif
+
+	/*!
+	@brief ӱ̰߳ȫջȡһջִУڼ䲻л
 	*/
 	void switchInvoke(const wrap_local_handler_face<void()>& handler);
 
+	/*!
+	@brief ӱ̰߳ȫջȡһջִУڼͨhostCtxгɺջ黹ʱ̵߳ĳ
+	@param hostCtx õActorcontextִڼָָȫջ
+	*/
+	void deepInvoke(const wrap_local_handler_face<void()>& handler, context_yield::context_info* hostCtx);
+
+	/*!
+	@brief ¼һrun_in_thread_stack
+	*/
+	void recordThreadStack(long long us);
+
 	/*!
 	@brief ǰ߳io_engine
 	*/
 	static io_engine* currentEngine();
 
+	/*!
+	@brief ǰ߳ڵNUMAڵ(runNuma߳Ϊ0)
+	*/
+	static size_t currentNode();
+
 	/*!
 	@brief ڷios߳гʼһtlsռ
 	*/
@@ -188,20 +335,84 @@ public:
 	@brief ȡtlsռ
 	*/
 	static void** getTlsValueBuff();
+
+	/*!
+	@brief ǰִ߳strandοʼʱʱ(΢)ENABLE_LOOP_TICK¶ʱʱӣ
+	strandлδʱͬget_tick_us
+	*/
+	static long long loopTickUs();
 private:
 	friend my_actor;
 	static void install();
 	static void uninstall();
+	static shared_obj_pool<boost_strand>* new_strand_pool();
+	void runGroups(const std::vector<size_t>& threadNodes, const std::vector<std::vector<int> >& nodeCpus, sched policy);
+	void startThreads(const std::vector<size_t>& slots);
+	size_t openSlot();
+	void openWorker(size_t slot);
+	size_t runAsio(boost::asio::io_service& ios, IdleSpin_& idleSpin, bool* retired = NULL);
+	bool takeRetire();
+	size_t runShard(size_t index, IdleSpin_& idleSpin);
+	size_t nextShard(size_t numaNode);
+	static SafeStack_* popSafeStack();
+	static void pushSafeStack(SafeStack_* safeStack);
+	void recordBlock(long long us);
+#ifdef ENABLE_STRAND_STATS
+	StrandStats_* popThreadStats();
+	void pushThreadStats(StrandStats_* stats);
+#endif
+#if (defined ENABLE_SHARED_TIMER) && !(defined DISABLE_BOOST_TIMER)
+	SharedTimer_* sharedTimer(boost::asio::io_service& ios, const void* key);
+#endif
+private:
+	struct safe_stack_counter
+	{
+		safe_stack_counter();
+		void reset();
+		safe_stack_stats get() const;
+
+		std::atomic<long long> _safeCount;
+		std::atomic<long long> _safeTime;
+		std::atomic<long long> _deepCount;
+		std::atomic<long long> _deepTime;
+		std::atomic<long long> _threadCount;
+		std::atomic<long long> _threadTime;
+		std::atomic<long long> _maxBlockTime;
+	};
 private:
 	bool _opend;
 	size_t _poolSize;
 	shared_obj_pool<boost_strand>* _strandPool;
+	std::vector<shared_obj_pool<boost_strand>*> _pinnedStrandPool;
+	std::vector<shared_obj_pool<boost_strand>*> _nodeStrandPool;
+	std::vector<shared_obj_pool<boost_strand>*> _retiredStrandPool;
+	shared_obj_pool<boost_strand>* _classStrandPool[strand_class_num];
+	StrandClassQueue_* _classQueue;
+	std::vector<std::vector<int> > _nodeCpus;
+	std::vector<size_t> _threadNode;
+	size_t _numaNodes;
+	StealScheduler_* _stealScheduler;
+	engine_mode _mode;
+	std::vector<boost::asio::io_service*> _shardIos;
+	std::atomic<size_t> _shardRound;
+	idle_policy _idlePolicy;
+	IdleSpin_::counter _idleStats;
+	safe_stack_counter _safeStackStats;
+	static std::atomic<long long> _safeStackCount;
+#ifdef ENABLE_STRAND_STATS
+	std::mutex _statsMutex;
+	std::vector<StrandStats_*> _threadStats;//ÿ߳һݣ߳˳̸߳
+	std::vector<StrandStats_*> _freeThreadStats;
+#endif
 #ifdef DISABLE_BOOST_TIMER
 #ifdef ENABLE_GLOBAL_TIMER
 	static WaitableTimer_* _waitableTimer;
 #else
 	WaitableTimer_* _waitableTimer;
 #endif
+#elif (defined ENABLE_SHARED_TIMER)
+	std::vector<std::pair<boost::asio::io_service*, std::vector<SharedTimer_*> > > _sharedTimers;//ÿio_service(Ƭ)һ鹲ʱ
+	std::mutex _sharedTimerMutex;
 #endif
 	priority _priority;
 	std::string _title;
@@ -209,7 +420,12 @@ private:
 	std::mutex _ctrlMutex;
 	std::atomic<long long> _runCount;
 	std::set<run_thread::thread_id> _threadsID;
+	std::atomic<size_t> _threadCount;
 	std::list<run_thread*> _runThreads;
+	std::vector<size_t> _freeSlots;//߳̿ճ
+	std::vector<std::pair<size_t, run_thread::thread_id> > _retiredThreads;
+	std::condition_variable _retireVar;
+	std::atomic<size_t> _retireRequest;//asio_strandģʽ´۵߳
 	boost::asio::io_service _ios;
 #ifdef WIN32
 	std::vector<HANDLE> _handleList;
@@ -470,6 +470,106 @@ private:
 };
 //////////////////////////////////////////////////////////////////////////
 
+/*!
+@brief ʽߵ߶(Vyukov)push̵߳ãpop/empty̵ֻ߳
+*/
+class mpsc_queue
+{
+public:
+	struct face
+	{
+		friend mpsc_queue;
+	private:
+		std::atomic<face*> _next;
+	};
+
+	mpsc_queue()
+		:_head(&_stub), _tail(&_stub)
+	{
+		_stub._next = NULL;
+	}
+
+	~mpsc_queue()
+	{
+		assert(empty());
+	}
+public:
+	void push(face* newFace)
+	{
+		newFace->_next.store(NULL, std::memory_order_relaxed);
+		face* const prev = _head.exchange(newFace);
+		prev->_next.store(newFace, std::memory_order_release);
+	}
+
+	/*!
+	@brief һlinkӺõfirstlastһڵ㣬ֻһԭӽ
+	*/
+	void push(face* first, face* last)
+	{
+		last->_next.store(NULL, std::memory_order_relaxed);
+		face* const prev = _head.exchange(last);
+		prev->_next.store(first, std::memory_order_release);
+	}
+
+	/*!
+	@brief ǰһڵ
+	*/
+	static void link(face* prev, face* next)
+	{
+		prev->_next.store(next, std::memory_order_relaxed);
+	}
+
+	/*!
+	@brief Ϊգ;ʱNULL
+	*/
+	face* pop()
+	{
+		face* tail = _tail;
+		face* next = tail->_next.load(std::memory_order_acquire);
+		if (&_stub == tail)
+		{
+			if (!next)
+			{
+				return NULL;
+			}
+			_tail = next;
+			tail = next;
+			next = next->_next.load(std::memory_order_acquire);
+		}
+		if (next)
+		{
+			_tail = next;
+			return tail;
+		}
+		if (tail != _head.load())
+		{
+			return NULL;
+		}
+		push(&_stub);
+		next = tail->_next.load(std::memory_order_acquire);
+		if (next)
+		{
+			_tail = next;
+			return tail;
+		}
+		return NULL;
+	}
+
+	/*!
+	@brief ;ʱҲΪǿ
+	*/
+	bool empty()
+	{
+		return &_stub == _tail && &_stub == _head.load();
+	}
+private:
+	std::atomic<face*> _head;
+	face* _tail;
+	face _stub;
+	NONE_COPY(mpsc_queue);
+};
+//////////////////////////////////////////////////////////////////////////
+
 template <size_t size>
 struct FixedNodeAlignTwoPow_ { enum { value = size }; typedef __space_align char type; };
 template <> struct FixedNodeAlignTwoPow_<1> { enum { value = 1 }; typedef char type; };
@@ -21,6 +21,15 @@ typedef boost::shared_mutex _shared_mutex;
 #include <signal.h>
 #include <sys/mman.h>
 #endif
+#include <fstream>
+
+//ջԤ(ļ֮һһҳ)
+#ifndef AUTO_STACK_PROFILE_MARGIN
+#define AUTO_STACK_PROFILE_MARGIN 8
+#endif
+
+//Ϊļ·ʱinstallʱauto_stackջʹõuninstallʱ
+//#define AUTO_STACK_PROFILE "actor_stack.profile"
 
 DEBUG_OPERATION(static run_thread::thread_id s_installID);
 static bool s_inited = false;
@@ -47,12 +56,61 @@ struct autoActorStackMng
 	{
 		_unique_lock<_shared_mutex> ul(_mutex);
 		_table[key] = ns;
+		_imported.erase(key);
+	}
+
+	void import_stack_size(size_t key, size_t ns)
+	{
+		//ҳȡѧĿ
+		size_t bucket = MEM_ALIGN(ns + std::max(ns / AUTO_STACK_PROFILE_MARGIN, (size_t)MEM_PAGE_SIZE), MEM_PAGE_SIZE);
+		bucket = std::min(bucket, (size_t)MAX_STACKSIZE);
+		_unique_lock<_shared_mutex> ul(_mutex);
+		if (_table.end() == _table.find(key) || _imported.end() != _imported.find(key))
+		{
+			_table[key] = bucket;
+			_imported[key] = ns;
+		}
+	}
+
+	std::map<size_t, size_t> snapshot()
+	{
+		//Ŀԭʼÿβظ
+		_shared_lock<_shared_mutex> sl(_mutex);
+		std::map<size_t, size_t> res = _table;
+		for (auto& ele : _imported)
+		{
+			res[ele.first] = ele.second;
+		}
+		return res;
 	}
 
 	std::map<size_t, size_t> _table;
+	std::map<size_t, size_t> _imported;//ӵԭʼ
 	_shared_mutex _mutex;
 };
 
+size_t auto_stack_key(const char* file, int line, int ordinal)
+{
+	//ֻȡļ__FILE__·͹Ŀ¼仯
+	const char* name = file;
+	for (const char* p = file; *p; p++)
+	{
+		if ('/' == *p || '\\' == *p)
+		{
+			name = p + 1;
+		}
+	}
+	const unsigned long long prime = 0x100000001B3ULL;
+	unsigned long long h = 0xCBF29CE484222325ULL;
+	for (const char* p = name; *p; p++)
+	{
+		h = (h ^ (unsigned char)*p) * prime;
+	}
+	h = (h ^ (unsigned long long)(unsigned)line) * prime;
+	h = (h ^ (unsigned long long)(unsigned)ordinal) * prime;
+	return (size_t)h;
+}
+
 struct shared_initer 
 {
 	std::recursive_mutex* _traceMutex = NULL;
@@ -87,6 +145,9 @@ void my_actor::install()
 		s_checkPumpLostObjAlloc = make_shared_space_alloc<CheckPumpLost_, mem_alloc_tls<CHECK_PUMP_LOST_ALLOC_INDEX, void>>(MEM_POOL_LENGTH, [](CheckPumpLost_*){});
 #endif
 		s_autoActorStackMng = new autoActorStackMng;
+#ifdef AUTO_STACK_PROFILE
+		import_stack_profile(AUTO_STACK_PROFILE);
+#endif
 		shared_bool::_sharedBoolAlloc = make_shared_space_alloc<bool, mem_alloc_tls<SHARED_BOOL_ALLOC_INDEX, void>>(MEM_POOL_LENGTH, [](bool*){});
 		my_actor::_actorIDCount = new std::atomic<my_actor::id>(0);
 		s_shared_initer._actorIDCount = my_actor::_actorIDCount;
@@ -116,6 +177,9 @@ void my_actor::install(const shared_initer* initer)
 		s_checkPumpLostObjAlloc = make_shared_space_alloc<CheckPumpLost_, mem_alloc_tls<CHECK_PUMP_LOST_ALLOC_INDEX, void>>(MEM_POOL_LENGTH, [](CheckPumpLost_*){});
 #endif
 		s_autoActorStackMng = new autoActorStackMng;
+#ifdef AUTO_STACK_PROFILE
+		import_stack_profile(AUTO_STACK_PROFILE);
+#endif
 		shared_bool::_sharedBoolAlloc = make_shared_space_alloc<bool, mem_alloc_tls<SHARED_BOOL_ALLOC_INDEX, void>>(MEM_POOL_LENGTH, [](bool*){});
 		my_actor::_actorIDCount = initer->_actorIDCount;
 		s_shared_initer._actorIDCount = initer->_actorIDCount;
@@ -139,6 +203,9 @@ void my_actor::uninstall()
 		my_actor::_actorIDCount = NULL;
 		delete my_actor::msg_pool_status::_msgTypeMapAll;
 		my_actor::msg_pool_status::_msgTypeMapAll = NULL;
+#ifdef AUTO_STACK_PROFILE
+		export_stack_profile(AUTO_STACK_PROFILE);
+#endif
 		delete s_autoActorStackMng;
 		s_autoActorStackMng = NULL;
 #ifdef ENABLE_CHECK_LOST
@@ -166,10 +233,85 @@ const shared_initer* my_actor::get_initer()
 {
 	return &s_shared_initer;
 }
+
+bool my_actor::export_stack_profile(const char* path)
+{
+	assert(s_autoActorStackMng);
+	std::map<size_t, size_t> table = s_autoActorStackMng->snapshot();
+	std::ofstream file(path, std::ios::out | std::ios::trunc);
+	if (!file)
+	{
+		return false;
+	}
+	file << "auto_stack_profile " << sizeof(size_t) << "\n";
+	for (auto& ele : table)
+	{
+		file << std::hex << ele.first << " " << std::dec << ele.second << "\n";
+	}
+	file.flush();
+	return file.good();
+}
+
+ContextPool_::pool_stats my_actor::stack_pool_stats()
+{
+	return ContextPool_::stats();
+}
+
+void my_actor::set_stack_budget(size_t budget)
+{
+	ContextPool_::set_budget(budget);
+}
+
+size_t my_actor::trim_stack_pool()
+{
+	return ContextPool_::trim();
+}
+
+void my_actor::set_stack_sampling(bool enable)
+{
+	ContextPool_::set_sampling(enable);
+}
+
+std::vector<ContextPool_::stack_site_stats> my_actor::sampled_stack_sites()
+{
+	return ContextPool_::sampled_sites();
+}
+
+std::vector<ContextPool_::stack_site_stats> my_actor::scan_stack_sites()
+{
+	return ContextPool_::scan_sites();
+}
+
+bool my_actor::import_stack_profile(const char* path)
+{
+	assert(s_autoActorStackMng);
+	std::ifstream file(path);
+	std::string head;
+	size_t keyBytes = 0;
+	if (!(file >> head >> keyBytes) || "auto_stack_profile" != head)
+	{
+		return false;
+	}
+	if (sizeof(size_t) != keyBytes)
+	{
+		//Ȳͬ(32/64λ)ĵϣֵͨ
+		return false;
+	}
+	size_t key = 0, ns = 0;
+	while (file >> std::hex >> key >> std::dec >> ns)
+	{
+		if (ns)
+		{
+			s_autoActorStackMng->import_stack_size(key, ns);
+		}
+	}
+	return true;
+}
 //////////////////////////////////////////////////////////////////////////
 
 void my_actor::tls_init()
 {
+	ContextPool_::tls_init();
 	shared_bool::_sharedBoolAlloc->tls_init();
 #ifdef ENABLE_CHECK_LOST
 	s_checkLostObjAlloc->tls_init();
@@ -184,6 +326,7 @@ void my_actor::tls_uninit()
 	s_checkLostObjAlloc->tls_uninit();
 #endif
 	shared_bool::_sharedBoolAlloc->tls_uninit();
+	ContextPool_::tls_uninit();
 }
 
 void** MemAllocTls_::getTlsValueBuff()
@@ -258,17 +401,19 @@ shared_bool shared_bool::new_(bool b)
 //////////////////////////////////////////////////////////////////////////
 #ifdef ENABLE_CHECK_LOST
 CheckLost_::CheckLost_(const shared_strand& strand, msg_handle_base* msgHandle)
-:_strand(strand), _handle(msgHandle), _closed(msgHandle->_closed) {}
+:_strand(strand), _handle(msgHandle), _closed(msgHandle->_closed), _hostActor(msgHandle->_hostActor) {}
 
 CheckLost_::~CheckLost_()
 {
 	if (!_closed)
 	{
 		auto& handle_ = _handle;
-		_strand->try_tick(std::bind([handle_](const shared_bool& closed)
+		auto& hostActor_ = _hostActor;
+		_strand->try_tick(std::bind([handle_, hostActor_](const shared_bool& closed)
 		{
 			if (!closed)
 			{
+				ActorFunc_::restore_stack(hostActor_);
 				handle_->lost_msg();
 			}
 		}, std::move(_closed)));
@@ -556,7 +701,7 @@ void MsgPoolVoid_::push_msg(const actor_handle& hostActor)
 	}
 	else
 	{
-		_strand->post(std::bind([](actor_handle& hostActor, const std::shared_ptr<MsgPoolVoid_>& sharedThis)
+		_strand->post_batch(std::bind([](actor_handle& hostActor, const std::shared_ptr<MsgPoolVoid_>& sharedThis)
 		{
 			sharedThis->send_msg(std::move(hostActor));
 		}, hostActor, _weakThis.lock()));
@@ -1370,17 +1515,17 @@ void my_actor::suspend_guard::unlock()
 }
 //////////////////////////////////////////////////////////////////////////
 
-ActorReadyGo_::ActorReadyGo_(shared_strand strand, size_t stackSize)
-: _strand(std::move(strand)), _stackSize(stackSize) {}
+ActorReadyGo_::ActorReadyGo_(shared_strand strand, size_t stackSize, int flags)
+: _strand(std::move(strand)), _stackSize(stackSize), _flags(flags) {}
 
-ActorReadyGo_::ActorReadyGo_(io_engine& ios, size_t stackSize)
-: _strand(boost_strand::create(ios)), _stackSize(stackSize) {}
+ActorReadyGo_::ActorReadyGo_(io_engine& ios, size_t stackSize, int flags)
+: _strand(boost_strand::create(ios)), _stackSize(stackSize), _flags(flags) {}
 
-ActorReadyGo_::ActorReadyGo_(shared_strand strand, std::function<void()> notify, size_t stackSize)
-: _strand(std::move(strand)), _notify(std::move(notify)), _stackSize(stackSize) {}
+ActorReadyGo_::ActorReadyGo_(shared_strand strand, std::function<void()> notify, size_t stackSize, int flags)
+: _strand(std::move(strand)), _notify(std::move(notify)), _stackSize(stackSize), _flags(flags) {}
 
-ActorReadyGo_::ActorReadyGo_(io_engine& ios, std::function<void()> notify, size_t stackSize)
-: _strand(boost_strand::create(ios)), _notify(std::move(notify)), _stackSize(stackSize) {}
+ActorReadyGo_::ActorReadyGo_(io_engine& ios, std::function<void()> notify, size_t stackSize, int flags)
+: _strand(boost_strand::create(ios)), _notify(std::move(notify)), _stackSize(stackSize), _flags(flags) {}
 //////////////////////////////////////////////////////////////////////////
 
 class my_actor::actor_run
@@ -1490,21 +1635,7 @@ public:
 #ifdef WIN32
 	static size_t clean_size(context_yield::context_info* const info)
 	{
-		char* const sb = (char*)info->stackTop - info->stackSize - info->reserveSize;
-		MEMORY_BASIC_INFORMATION mbi;
-		VirtualQuery(sb, &mbi, sizeof(mbi));
-		assert(sb == mbi.AllocationBase);
-		if (MEM_RESERVE == mbi.State)
-		{
-			assert(0 == mbi.Protect);
-			return mbi.RegionSize + MEM_PAGE_SIZE;
-		}
-		else if ((PAGE_READWRITE | PAGE_GUARD) == mbi.Protect)
-		{
-			assert(MEM_COMMIT == mbi.State && MEM_PAGE_SIZE == mbi.RegionSize);
-			return MEM_PAGE_SIZE;
-		}
-		return 0;
+		return info->stackSize + info->reserveSize - context_yield::stack_used_size(info);
 	}
 
 	void check_stack()
@@ -1541,7 +1672,7 @@ public:
 			{
 				exit_notify();
 			}
-			if (_actor._afterExitCleanStack)
+			if (_actor._afterExitCleanStack && !(_actor._actorPull->_flags & stack_no_decommit))
 			{
 				_actor._actorPull->_tick = 1;
 			}
@@ -1569,7 +1700,7 @@ public:
 			{
 				exit_notify();
 			}
-			if (_actor._afterExitCleanStack)
+			if (_actor._afterExitCleanStack && !(_actor._actorPull->_flags & stack_no_decommit))
 			{
 				_actor._actorPull->_tick = 1;
 			}
@@ -1680,19 +1811,7 @@ public:
 
 	static size_t clean_size(context_yield::context_info* const info)
 	{
-		unsigned char mvec[256];
-		const size_t totalStackSize = info->stackSize + info->reserveSize;
-		char* const sb = (char*)info->stackTop - totalStackSize;
-		bool ok = 0 == mincore(sb, totalStackSize, mvec);
-		assert(ok);
-		for (size_t i = 0; i < totalStackSize; i += MEM_PAGE_SIZE)
-		{
-			if (0 != mvec[i / MEM_PAGE_SIZE])
-			{
-				return i;
-			}
-		}
-		return totalStackSize;
+		return info->stackSize + info->reserveSize - context_yield::stack_used_size(info);
 	}
 
 	void check_stack()
@@ -1725,13 +1844,13 @@ public:
 		{
 			exit_notify();
 		}
-		if (_actor._afterExitCleanStack)
+		if (_actor._afterExitCleanStack && !(_actor._actorPull->_flags & stack_no_decommit))
 		{
 			_actor._actorPull->_tick = 1;
 		}
 	}
 
-#if (__linux__ && ENABLE_DUMP_STACK)
+#if (__linux__ && (ENABLE_DUMP_STACK || (defined ENABLE_GROWABLE_STACK)))
 	static void dump_segmentation_fault(void* sp, size_t length)
 	{
 		stack_t sigaltStack;
@@ -1746,8 +1865,27 @@ public:
 		sigAction.sa_flags = SA_SIGINFO | SA_ONSTACK;
 		sigAction.sa_sigaction = [](int signum, siginfo_t* info, void* ptr)
 		{
-			TraceMutex_ mt;
 			ucontext_t* const ucontext = (ucontext_t*)ptr;
+#ifdef ENABLE_GROWABLE_STACK
+#ifdef __x86_64__
+			void* const sp = (void*)ucontext->uc_mcontext.gregs[REG_RSP];
+#elif __i386__
+			void* const sp = (void*)ucontext->uc_mcontext.gregs[REG_ESP];
+#elif _ARM32
+			void* const sp = (void*)ucontext->uc_mcontext.arm_sp;
+#elif _ARM64
+			void* const sp = (void*)ucontext->uc_mcontext.sp;
+#else
+			void* const sp = NULL;
+#endif
+			if (context_yield::grow_stack(info->si_addr, sp))
+			{
+				//ջչغִзָ
+				return;
+			}
+#endif
+#ifdef ENABLE_DUMP_STACK
+			TraceMutex_ mt;
 #if (__i386__ || __x86_64__)
 			void* const fault_address = (void*)ucontext->uc_sigmask.__val[3];
 #elif (_ARM32 || _ARM64)
@@ -1795,6 +1933,10 @@ public:
 			}
 			std::wcout << "exit" << std::endl << std::flush;
 			exit(102);
+#else
+			//ջķʴ󣬻ָĬϴغ´
+			signal(SIGSEGV, SIG_DFL);
+#endif
 		};
 		sigaction(SIGSEGV, &sigAction, NULL);
 	}
@@ -1812,7 +1954,7 @@ private:
 	my_actor& _actor;
 };
 
-#if (__linux__ && ENABLE_DUMP_STACK)
+#if (__linux__ && (ENABLE_DUMP_STACK || (defined ENABLE_GROWABLE_STACK)))
 void my_actor::dump_segmentation_fault(void* sp, size_t length)
 {
 	actor_run::dump_segmentation_fault(sp, length);
@@ -1846,6 +1988,7 @@ my_actor::my_actor()
 	_checkStack = false;
 	_waitingQuit = false;
 	_afterExitCleanStack = false;
+	_inDeepStack = false;
 #ifdef PRINT_ACTOR_STACK
 	_checkStackFree = false;
 #endif
@@ -1903,9 +2046,9 @@ my_actor& my_actor::operator =(const my_actor&)
 	return *this;
 }
 
-actor_handle my_actor::create(shared_strand actorStrand, main_func mainFunc, size_t stackSize)
+actor_handle my_actor::create(shared_strand actorStrand, main_func mainFunc, size_t stackSize, int flags)
 {
-	actor_pull_type* pull = ContextPool_::getContext(stackSize);
+	actor_pull_type* pull = ContextPool_::getContext(stackSize, flags);
 	if (!pull)
 	{
 		error_trace_line("stack memory exhaustion");
@@ -1917,6 +2060,7 @@ actor_handle my_actor::create(shared_strand actorStrand, main_func mainFunc, siz
 	newActor->_strand = std::move(actorStrand);
 	newActor->_mainFunc = std::move(mainFunc);
 	newActor->_actorPull = pull;
+	pull->_site = &newActor->_mainFunc.target_type();
 #ifdef PRINT_ACTOR_STACK
 	newActor->_createStack = get_stack_list(8, 1);
 #endif
@@ -1934,6 +2078,9 @@ actor_handle my_actor::create(shared_strand actorStrand, AutoStackActorFace_&& w
 {
 	actor_pull_type* pull = NULL;
 	const size_t nsize = wrapActor.stack_size();
+	//̽ջʱԤȴ/ջΪ
+	const int flags = wrapActor.stack_flags();
+	const int checkFlags = flags & ~(stack_prefault | stack_lock);
 	bool checkStack = false;
 	if (nsize)
 	{
@@ -1941,11 +2088,11 @@ actor_handle my_actor::create(shared_strand actorStrand, AutoStackActorFace_&& w
 		{
 			size_t lasts = s_autoActorStackMng->get_stack_size(wrapActor.key());
 			checkStack = !lasts;
-			pull = ContextPool_::getContext(lasts ? lasts : GET_TRY_SIZE(nsize));
+			pull = ContextPool_::getContext(lasts ? lasts : GET_TRY_SIZE(nsize), checkStack ? checkFlags : flags);
 		}
 		else
 		{
-			pull = ContextPool_::getContext(nsize);
+			pull = ContextPool_::getContext(nsize, flags);
 			checkStack = false;
 		}
 	}
@@ -1953,7 +2100,7 @@ actor_handle my_actor::create(shared_strand actorStrand, AutoStackActorFace_&& w
 	{
 		size_t lasts = s_autoActorStackMng->get_stack_size(wrapActor.key());
 		checkStack = !lasts;
-		pull = ContextPool_::getContext(lasts ? lasts : MAX_STACKSIZE);
+		pull = ContextPool_::getContext(lasts ? lasts : MAX_STACKSIZE, checkStack ? checkFlags : flags);
 	}
 	if (!pull)
 	{
@@ -1968,6 +2115,7 @@ actor_handle my_actor::create(shared_strand actorStrand, AutoStackActorFace_&& w
 	wrapActor.swap(newActor->_mainFunc);
 	newActor->_actorKey = wrapActor.key();
 	newActor->_actorPull = pull;
+	pull->_site = &newActor->_mainFunc.target_type();
 #ifdef PRINT_ACTOR_STACK
 	newActor->_createStack = get_stack_list(8, 1);
 #endif
@@ -1982,17 +2130,43 @@ actor_handle my_actor::create(shared_strand actorStrand, AutoStackActorFace_&& w
 	return newActor;
 }
 
-child_handle my_actor::create_child(shared_strand actorStrand, main_func mainFunc, size_t stackSize)
+actor_handle my_actor::create_spill(shared_strand actorStrand, main_func mainFunc, size_t promoteThreshold)
+{
+	actor_pull_type* pull = ContextPool_::getSpillContext(promoteThreshold);
+	if (!pull)
+	{
+		return create(std::move(actorStrand), std::move(mainFunc), SPILL_STACK_SIZE);
+	}
+	actor_handle newActor(new(pull->_space)my_actor(), [](my_actor* p){p->~my_actor(); }, actor_ref_count_alloc<void>(pull));
+	newActor->_weakThis = newActor;
+	newActor->_strand = std::move(actorStrand);
+	newActor->_mainFunc = std::move(mainFunc);
+	newActor->_actorPull = pull;
+	pull->_site = &newActor->_mainFunc.target_type();
+#ifdef PRINT_ACTOR_STACK
+	newActor->_createStack = get_stack_list(8, 1);
+#endif
+
+	pull->_param = newActor.get();
+	pull->_currentHandler = [](actor_push_type& push, void* p)
+	{
+		(actor_run(*(my_actor*)p)).run(push);
+	};
+	pull->yield();
+	return newActor;
+}
+
+child_handle my_actor::create_child(shared_strand actorStrand, main_func mainFunc, size_t stackSize, int flags)
 {
 	assert_enter();
-	actor_handle childActor = my_actor::create(std::move(actorStrand), std::move(mainFunc), stackSize);
+	actor_handle childActor = my_actor::create(std::move(actorStrand), std::move(mainFunc), stackSize, flags);
 	childActor->_parentActor = shared_from_this();
 	return child_handle(std::move(childActor));
 }
 
-child_handle my_actor::create_child(main_func mainFunc, size_t stackSize)
+child_handle my_actor::create_child(main_func mainFunc, size_t stackSize, int flags)
 {
-	return create_child(_strand, std::move(mainFunc), stackSize);
+	return create_child(_strand, std::move(mainFunc), stackSize, flags);
 }
 
 child_handle my_actor::create_child(shared_strand actorStrand, AutoStackActorFace_&& wrapActor)
@@ -2008,6 +2182,19 @@ child_handle my_actor::create_child(AutoStackActorFace_&& wrapActor)
 	return create_child(_strand, std::move(wrapActor));
 }
 
+child_handle my_actor::create_spill_child(shared_strand actorStrand, main_func mainFunc, size_t promoteThreshold)
+{
+	assert_enter();
+	actor_handle childActor = my_actor::create_spill(std::move(actorStrand), std::move(mainFunc), promoteThreshold);
+	childActor->_parentActor = shared_from_this();
+	return child_handle(std::move(childActor));
+}
+
+child_handle my_actor::create_spill_child(main_func mainFunc, size_t promoteThreshold)
+{
+	return create_spill_child(_strand, std::move(mainFunc), promoteThreshold);
+}
+
 void my_actor::child_run(child_handle& actorHandle)
 {
 	assert_enter();
@@ -3193,15 +3380,19 @@ void my_actor::run_one()
 
 void my_actor::pull_yield_tls()
 {
+	//ڼpost_batch_scopeactorֻܿԼ
+	void** const tlsBuff = io_engine::getTlsValueBuff();
+	void* const batchScope = tlsBuff[POST_BATCH_INDEX];
+	tlsBuff[POST_BATCH_INDEX] = NULL;
 #if ((__linux__ && (defined ENABLE_DUMP_STACK || (defined CHECK_SELF))) || (WIN32 && (_WIN32_WINNT < 0x0502) && (defined CHECK_SELF)))
-	void*& tlsVal = io_engine::getTlsValueRef(ACTOR_TLS_INDEX);
-	void* old = tlsVal;
-	tlsVal = this;
+	void* old = tlsBuff[ACTOR_TLS_INDEX];
+	tlsBuff[ACTOR_TLS_INDEX] = this;
 	_actorPull->yield();
-	tlsVal = old;
+	tlsBuff[ACTOR_TLS_INDEX] = old;
 #else
 	_actorPull->yield();
 #endif
+	tlsBuff[POST_BATCH_INDEX] = batchScope;
 }
 
 void my_actor::pull_yield()
@@ -3228,6 +3419,8 @@ void my_actor::push_yield()
 {
 	assert(!_exited);
 	assert(_inActor);
+	//post_batch_scopeڲгactorݴactorǨƻactor
+	assert(!io_engine::getTlsValue(POST_BATCH_INDEX));
 	check_stack();
 	_yieldCount++;
 	_inActor = false;
@@ -3249,6 +3442,19 @@ void my_actor::push_yield()
 	}
 }
 
+void my_actor::push_yield_idle()
+{
+	//лջActorڴгջ֡ɱѷдջ϶ǰȿ
+	ContextPool_::idle_yield(_actorPull);
+	push_yield();
+}
+
+void my_actor::restore_stack()
+{
+	assert(_strand->running_in_this_thread());
+	ContextPool_::restore_stack(_actorPull);
+}
+
 void my_actor::push_yield_after_quited()
 {
 	check_stack();
@@ -3263,6 +3469,8 @@ void my_actor::timeout_handler()
 	_timerStateHandle.reset();
 	if (_timerStateCb)
 	{
+		//ʱصдȴеActorջ϶
+		restore_stack();
 		wrap_timer_handler_face* h = _timerStateCb;
 		_timerStateCb = NULL;
 		h->invoke();
@@ -3326,7 +3534,7 @@ void my_actor::check_stack()
 {
 #ifdef PRINT_ACTOR_STACK
 	context_yield::context_info* const info = _actorPull->_coroInfo;
-	if ((size_t)get_sp() < (size_t)info->stackTop - info->stackSize)
+	if (!_inDeepStack && (size_t)get_sp() < (size_t)info->stackTop - info->stackSize)
 	{
 		stack_overflow_format((int)((size_t)get_sp() - (size_t)info->stackTop - info->stackSize), _createStack);
 	}
@@ -3402,7 +3610,7 @@ bool my_actor::_timed_wait_msg(int ms, const wrap_local_handler_face<void()>& th
 				overtime = true;
 				th();
 			});
-			push_yield();
+			push_yield_idle();
 			if (overtime)
 			{
 				return false;
@@ -3411,7 +3619,7 @@ bool my_actor::_timed_wait_msg(int ms, const wrap_local_handler_face<void()>& th
 		}
 		else if (ms < 0)
 		{
-			push_yield();
+			push_yield_idle();
 		}
 		else
 		{
@@ -3444,7 +3652,7 @@ bool my_actor::_timed_wait_trig_sign(int ms, int id, const wrap_local_handler_fa
 				overtime = true;
 				th();
 			});
-			push_yield();
+			push_yield_idle();
 			if (overtime)
 			{
 				return false;
@@ -3453,7 +3661,7 @@ bool my_actor::_timed_wait_trig_sign(int ms, int id, const wrap_local_handler_fa
 		}
 		else if (ms < 0)
 		{
-			push_yield();
+			push_yield_idle();
 		}
 		else
 		{
@@ -3659,6 +3867,12 @@ void ActorFunc_::pull_yield(my_actor* host)
 	host->pull_yield();
 }
 
+void ActorFunc_::restore_stack(my_actor* host)
+{
+	assert(host);
+	host->restore_stack();
+}
+
 void ActorFunc_::push_yield(my_actor* host)
 {
 	assert(host);
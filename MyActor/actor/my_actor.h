@@ -74,6 +74,7 @@ struct ActorFunc_
 	static const actor_handle& parent_actor(my_actor* host);
 	static const shared_strand& self_strand(my_actor* host);
 	static void pull_yield(my_actor* host);
+	static void restore_stack(my_actor* host);
 	static void push_yield(my_actor* host);
 	static void pull_yield_after_quited(my_actor* host);
 	static void push_yield_after_quited(my_actor* host);
@@ -122,6 +123,7 @@ private:
 	shared_strand _strand;
 	shared_bool _closed;
 	msg_handle_base* _handle;
+	my_actor* _hostActor;
 };
 
 class CheckPumpLost_
@@ -326,6 +328,7 @@ public:
 			typedef std::tuple<TYPE_PIPE(ARGS)...> args_tuple;
 			if (ActorFunc_::self_strand(_hostActor.get())->running_in_this_thread())
 			{
+				ActorFunc_::restore_stack(_hostActor.get());
 				_msgHandle->push_msg(args_tuple(std::forward<Args>(args)...));
 			}
 			else
@@ -334,6 +337,7 @@ public:
 				{
 					if (!closed)
 					{
+						ActorFunc_::restore_stack(hostActor.get());
 						msgHandle->push_msg(std::move(args));
 					}
 				}, _hostActor, _msgHandle, _closed, args_tuple(std::forward<Args>(args)...)));
@@ -349,6 +353,7 @@ public:
 		{
 			if (ActorFunc_::self_strand(_hostActor.get())->running_in_this_thread())
 			{
+				ActorFunc_::restore_stack(_hostActor.get());
 				_msgHandle->push_msg();
 			}
 			else
@@ -357,6 +362,7 @@ public:
 				{
 					if (!closed)
 					{
+						ActorFunc_::restore_stack(hostActor.get());
 						msgHandle->push_msg();
 					}
 				}, _hostActor, _msgHandle, _closed));
@@ -1629,7 +1635,7 @@ private:
 		}
 		else
 		{
-			_strand->post(std::bind([](actor_handle& hostActor, const std::shared_ptr<MsgPool_>& sharedThis, msg_type& msg)
+			_strand->post_batch(std::bind([](actor_handle& hostActor, const std::shared_ptr<MsgPool_>& sharedThis, msg_type& msg)
 			{
 				sharedThis->send_msg(std::move(msg), std::move(hostActor));
 			}, hostActor, _weakThis.lock(), std::move(mt)));
@@ -4325,14 +4331,15 @@ struct AutoStackActorFace_
 {
 	virtual size_t key() = 0;
 	virtual size_t stack_size() = 0;
+	virtual int stack_flags() = 0;
 	virtual void swap(std::function<void(my_actor*)>& sk) = 0;
 };
 
 template <typename Handler>
 struct AutoStackActor_ : public AutoStackActorFace_
 {
-	AutoStackActor_(Handler& h, size_t stackSize, size_t key)
-	:_h(h), _stackSize(stackSize), _key(key) {}
+	AutoStackActor_(Handler& h, size_t stackSize, size_t key, int flags = stack_default)
+	:_h(h), _stackSize(stackSize), _key(key), _flags(flags) {}
 
 	size_t key()
 	{
@@ -4344,6 +4351,11 @@ struct AutoStackActor_ : public AutoStackActorFace_
 		return _stackSize;
 	}
 
+	int stack_flags()
+	{
+		return _flags;
+	}
+
 	void swap(std::function<void(my_actor*)>& sk)
 	{
 		sk = (Handler)_h;
@@ -4351,53 +4363,72 @@ struct AutoStackActor_ : public AutoStackActorFace_
 
 	size_t _key;
 	size_t _stackSize;
+	int _flags;
 	Handler& _h;
 	NONE_COPY(AutoStackActor_);
-	RVALUE_CONSTRUCT(AutoStackActor_, _key, _stackSize, _h);
+	RVALUE_CONSTRUCT(AutoStackActor_, _key, _stackSize, _flags, _h);
 };
 
 template <typename Handler>
 struct AutoStackMsgAgentActor_
 {
-	AutoStackMsgAgentActor_(Handler& h, size_t stackSize, size_t key)
-	:_h(h), _stackSize(stackSize), _key(key) {}
+	AutoStackMsgAgentActor_(Handler& h, size_t stackSize, size_t key, int flags = stack_default)
+	:_h(h), _stackSize(stackSize), _key(key), _flags(flags) {}
 
 	size_t _key;
 	size_t _stackSize;
+	int _flags;
 	Handler& _h;
 	NONE_COPY(AutoStackMsgAgentActor_);
-	RVALUE_CONSTRUCT(AutoStackMsgAgentActor_, _key, _stackSize, _h);
+	RVALUE_CONSTRUCT(AutoStackMsgAgentActor_, _key, _stackSize, _flags, _h);
 };
 
+/*!
+@brief auto_stackõļȡԴļ(Ŀ¼)кźŵĹϣ뵥Ԫ·͹Ŀ¼޹
+@param ordinal ͬһжõʱ֣Ĭ0
+*/
+size_t auto_stack_key(const char* file, int line, int ordinal);
+
+//ÿõֻһμAUTO_STACK_KEY()AUTO_STACK_KEY()
+#define AUTO_STACK_KEY(...) []()->size_t{ static const size_t key = auto_stack_key(__FILE__, __LINE__, __VA_ARGS__ + 0); return key; }()
+
 struct AutoStack_
 {
-	AutoStack_(size_t stackSize, size_t key, size_t = 0)
-	:_stackSize(stackSize), _key(key) {}
+	AutoStack_(size_t stackSize, size_t key)
+	:_stackSize(stackSize), _key(key), _flags(stack_default) {}
+
+	AutoStack_(size_t stackSize, int flags, size_t key)
+	:_stackSize(stackSize), _key(key), _flags(flags) {}
 
 	template <typename Handler>
 	AutoStackActor_<Handler&&> operator *(Handler&& handler)
 	{
-		return AutoStackActor_<Handler&&>(handler, _stackSize, _key);
+		return AutoStackActor_<Handler&&>(handler, _stackSize, _key, _flags);
 	}
 
 	size_t _stackSize;
 	size_t _key;
+	int _flags;
 	NONE_COPY(AutoStack_);
 };
 
 struct AutoStackAgent_
 {
-	AutoStackAgent_(size_t stackSize, size_t key, size_t = 0)
-	:_stackSize(stackSize), _key(key) {}
+	AutoStackAgent_(size_t stackSize, size_t key)
+	:_stackSize(stackSize), _key(key), _flags(stack_default) {}
+
+	AutoStackAgent_(size_t stackSize, int flags, size_t key)
+	:_stackSize(stackSize), _key(key), _flags(flags) {}
 
 	template <typename Handler>
 	AutoStackMsgAgentActor_<Handler&&> operator *(Handler&& handler)
 	{
-		return AutoStackMsgAgentActor_<Handler&&>(handler, _stackSize, _key);
+		return AutoStackMsgAgentActor_<Handler&&>(handler, _stackSize, _key, _flags);
 	}
 
 	size_t _stackSize;
 	size_t _key;
+	int _flags;
 	NONE_COPY(AutoStackAgent_);
 };
 
@@ -4410,11 +4441,11 @@ struct AutoStackAgent_
 
 #else
 
-//Զջռ
-#define auto_stack(...) AutoStack_(__VA_ARGS__, __COUNTER__)*
-#define auto_stack_msg_agent(...) AutoStackAgent_(__VA_ARGS__, __COUNTER__)*
-#define auto_stack_ AutoStack_(0, __COUNTER__)*
-#define auto_stack_msg_agent_ AutoStackAgent_(0, __COUNTER__)*
+//Զջռƣauto_stack(ջߴ[, stack_flag])ͬһϵĶõ㹲һҪʱAutoStack_(ջߴ, AUTO_STACK_KEY())*
+#define auto_stack(...) AutoStack_(__VA_ARGS__, AUTO_STACK_KEY())*
+#define auto_stack_msg_agent(...) AutoStackAgent_(__VA_ARGS__, AUTO_STACK_KEY())*
+#define auto_stack_ AutoStack_(0, AUTO_STACK_KEY())*
+#define auto_stack_msg_agent_ AutoStackAgent_(0, AUTO_STACK_KEY())*
 
 #endif
 
@@ -4798,14 +4829,25 @@ public:
 	@param actorStrand Actorstrand
 	@param mainFunc Actorִ
 	@param stackSize ActorջСĬ64kֽڣ4kС4k1M
+	@param flags ջѡstack_flag
 	*/
-	static actor_handle create(shared_strand actorStrand, main_func mainFunc, size_t stackSize = DEFAULT_STACKSIZE);
+	static actor_handle create(shared_strand actorStrand, main_func mainFunc, size_t stackSize = DEFAULT_STACKSIZE, int flags = stack_default);
 	static actor_handle create(shared_strand actorStrand, AutoStackActorFace_&& wrapActor);
 
+	/*!
+	@brief һлջActorջɱActorռ(Actorִջ)wait_msg/wait_trig(msg_handle/trig_handle)trig_sign
+	ȴг󣬰õջ֡ϲ黹ջڴ棬ͶϢǰٿԭλ(ջַ)
+	ÿĵȴһmadviseϵͳáһοͻѺȱҳʱеActorֻռջ֡Сڴ棬
+	ƵշϢActorӦʹcreate(linuxֵ֧ƽ̨SPILL_STACK_SIZEСͨջ)
+	ȴڼ䣬Actorֱ̲߳ӷջϵĶ(Ϣ/Ͷݳ)
+	@param promoteThreshold ﵽٻջ֡פԼջϣ0
+	*/
+	static actor_handle create_spill(shared_strand actorStrand, main_func mainFunc, size_t promoteThreshold = SPILL_STACK_PROMOTE);
+
 	template <typename SharedStrand, typename MainFunc, typename NotifyFunc>
-	static actor_handle create_and_notify(SharedStrand&& actorStrand, MainFunc&& mainFunc, NotifyFunc&& notifyFunc, size_t stackSize = DEFAULT_STACKSIZE)
+	static actor_handle create_and_notify(SharedStrand&& actorStrand, MainFunc&& mainFunc, NotifyFunc&& notifyFunc, size_t stackSize = DEFAULT_STACKSIZE, int flags = stack_default)
 	{
-		actor_handle newActor = create(std::forward<SharedStrand>(actorStrand), std::forward<MainFunc>(mainFunc), stackSize);
+		actor_handle newActor = create(std::forward<SharedStrand>(actorStrand), std::forward<MainFunc>(mainFunc), stackSize, flags);
 		newActor->_quitCallback.push_back(std::forward<NotifyFunc>(notifyFunc));
 		return newActor;
 	}
@@ -4823,13 +4865,20 @@ public:
 	@param actorStrand Actorstrand
 	@param mainFunc Actorں
 	@param stackSize ActorջС4k1MB
+	@param flags ջѡstack_flag
 	@return Actor
 	*/
-	child_handle create_child(shared_strand actorStrand, main_func mainFunc, size_t stackSize = DEFAULT_STACKSIZE);
-	child_handle create_child(main_func mainFunc, size_t stackSize = DEFAULT_STACKSIZE);
+	child_handle create_child(shared_strand actorStrand, main_func mainFunc, size_t stackSize = DEFAULT_STACKSIZE, int flags = stack_default);
+	child_handle create_child(main_func mainFunc, size_t stackSize = DEFAULT_STACKSIZE, int flags = stack_default);
 	child_handle create_child(shared_strand actorStrand, AutoStackActorFace_&& wrapActor);
 	child_handle create_child(AutoStackActorFace_&& wrapActor);
 
+	/*!
+	@brief һлջActorμcreate_spill
+	*/
+	child_handle create_spill_child(shared_strand actorStrand, main_func mainFunc, size_t promoteThreshold = SPILL_STACK_PROMOTE);
+	child_handle create_spill_child(main_func mainFunc, size_t promoteThreshold = SPILL_STACK_PROMOTE);
+
 	/*!
 	@brief ʼActorֻܵһ
 	*/
@@ -5276,7 +5325,9 @@ public:
 		stack_obj<R> res;
 		_strand->next_tick(std::bind([&h, &res](actor_handle& shared_this)
 		{
+			const long long beginTick = get_tick_us();
 			CHECK_EXCEPTION(stack_agent_result::invoke, res, h);
+			shared_this->self_io_engine().recordThreadStack(get_tick_us() - beginTick);
 			shared_this->pull_yield();
 		}, shared_from_this()));
 		push_yield();
@@ -5302,6 +5353,45 @@ public:
 		return stack_obj_move::move(res);
 	}
 
+	/*!
+	@brief ̵߳İȫջȡһռջһԽл(ڿлջActorʹ)
+	׳쳣(ǿ˳)صActorջ׳
+	*/
+	template <typename H>
+	__yield_interrupt auto run_in_deep_stack(H&& h)->decltype(h())
+	{
+		return run_in_deep_stack<decltype(h())>(std::forward<H>(h));
+	}
+
+	template <typename R, typename H>
+	__yield_interrupt R run_in_deep_stack(H&& h)
+	{
+		assert_enter();
+		assert(!_actorPull->_spill);
+		assert(!_inDeepStack);
+		stack_obj<R> res;
+		std::exception_ptr ep;
+		auto th = [&]
+		{
+			try
+			{
+				stack_agent_result::invoke(res, h);
+			}
+			catch (...)
+			{
+				ep = std::current_exception();
+			}
+		};
+		_inDeepStack = true;
+		self_io_engine().deepInvoke(wrap_local_handler(th), _actorPull->_coroInfo);
+		_inDeepStack = false;
+		if (ep)
+		{
+			std::rethrow_exception(ep);
+		}
+		return stack_obj_move::move(res);
+	}
+
 	/*!
 	@brief ǿƽһ͵һshared_strandִУĳAPIкܶεĶջãǰActorջôл̶߳ջֱִУ
 	quit_guardʹ÷ֹʧЧɺ󷵻
@@ -5570,7 +5660,7 @@ private:
 					overtime = true;
 					th();
 				});
-				push_yield();
+				push_yield_idle();
 				if (overtime)
 				{
 					return false;
@@ -5579,7 +5669,7 @@ private:
 			}
 			else if (ms < 0)
 			{
-				push_yield();
+				push_yield_idle();
 			}
 			else
 			{
@@ -6420,7 +6510,7 @@ public:
 		{
 			msg_pump_handle<Args...> pump = my_actor::_connect_msg_pump<Args...>(id, self, false);
 			agentActor(self, pump);
-		}, (Handler)wrapActor._h, __1), wrapActor._stackSize, wrapActor._key));
+		}, (Handler)wrapActor._h, __1), wrapActor._stackSize, wrapActor._key, wrapActor._flags));
 		childActor->_parentActor = shared_from_this();
 		msg_agent_to<Args...>(id, childActor);
 		if (autoRun)
@@ -8112,6 +8202,46 @@ public:
 	*/
 	static void uninstall();
 
+	/*!
+	@brief auto_stackѧϰĸõʵջΪõԴλ(·+к+)Ĺϣinstall֮
+	*/
+	static bool export_stack_profile(const char* path);
+
+	/*!
+	@brief ջʹõҳȡеauto_stackõ״δʹøóߴ磬ٴջ̽
+	*/
+	static bool import_stack_profile(const char* path);
+
+	/*!
+	@brief Actorջͳ(Ѵջ/ַռ䡢ȫֳеĿջڴѹ״̬)
+	*/
+	static ContextPool_::pool_stats stack_pool_stats();
+
+	/*!
+	@brief ActorջַռԤ(ֽ)̲߳ٱջ0
+	*/
+	static void set_stack_budget(size_t budget);
+
+	/*!
+	@brief ͷȫֳпջͷŵĵַռ
+	*/
+	static size_t trim_stack_pool();
+
+	/*!
+	@brief ջ(ں)ͳƣȷջߴ磬Ҫauto_stack˳
+	*/
+	static void set_stack_sampling(bool enable);
+
+	/*!
+	@brief ۻĸջ(p50/p99/ƽδֽ)
+	*/
+	static std::vector<ContextPool_::stack_site_stats> sampled_stack_sites();
+
+	/*!
+	@brief ɨActorջ
+	*/
+	static std::vector<ContextPool_::stack_site_stats> scan_stack_sites();
+
 	/*!
 	@brief 
 	*/
@@ -8157,7 +8287,9 @@ private:
 	void pull_yield_after_quited();
 	void push_yield();
 	void push_yield_after_quited();
-#if (__linux__ && ENABLE_DUMP_STACK)
+	void push_yield_idle();
+	void restore_stack();
+#if (__linux__ && (ENABLE_DUMP_STACK || (defined ENABLE_GROWABLE_STACK)))
 	static void dump_segmentation_fault(void* sp, size_t length);
 	static void undump_segmentation_fault();
 #endif
@@ -8210,6 +8342,7 @@ private:
 	bool _checkStack : 1;///<Ƿջռ
 	bool _waitingQuit : 1;///<ȴ˳
 	bool _afterExitCleanStack : 1;///<ջ
+	bool _inDeepStack : 1;///<ڰȫջصĴջִ
 #ifdef PRINT_ACTOR_STACK
 public:
 	bool _checkStackFree : 1;///<Ƿջ
@@ -8222,10 +8355,10 @@ private:
 
 struct ActorReadyGo_
 {
-	ActorReadyGo_(shared_strand strand, size_t stackSize = MAX_STACKSIZE);
-	ActorReadyGo_(io_engine& ios, size_t stackSize = MAX_STACKSIZE);
-	ActorReadyGo_(shared_strand strand, std::function<void()> notify, size_t stackSize = MAX_STACKSIZE);
-	ActorReadyGo_(io_engine& ios, std::function<void()> notify, size_t stackSize = MAX_STACKSIZE);
+	ActorReadyGo_(shared_strand strand, size_t stackSize = MAX_STACKSIZE, int flags = stack_default);
+	ActorReadyGo_(io_engine& ios, size_t stackSize = MAX_STACKSIZE, int flags = stack_default);
+	ActorReadyGo_(shared_strand strand, std::function<void()> notify, size_t stackSize = MAX_STACKSIZE, int flags = stack_default);
+	ActorReadyGo_(io_engine& ios, std::function<void()> notify, size_t stackSize = MAX_STACKSIZE, int flags = stack_default);
 
 	template <typename Handler>
 	actor_handle operator -(AutoStackActor_<Handler>&& wrapActor)
@@ -8244,14 +8377,15 @@ struct ActorReadyGo_
 		assert(_strand);
 		if (_notify)
 		{
-			return my_actor::create_and_notify(std::move(_strand), std::move(handler), std::move(_notify), _stackSize);
+			return my_actor::create_and_notify(std::move(_strand), std::move(handler), std::move(_notify), _stackSize, _flags);
 		}
-		return my_actor::create(std::move(_strand), std::forward<Handler>(handler), _stackSize);
+		return my_actor::create(std::move(_strand), std::forward<Handler>(handler), _stackSize, _flags);
 	}
 
 	shared_strand _strand;
 	std::function<void()> _notify;
 	size_t _stackSize;
+	int _flags;
 	NONE_COPY(ActorReadyGo_);
 };
 
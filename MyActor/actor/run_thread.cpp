@@ -108,6 +108,53 @@ size_t run_thread::cpu_thread_number()
 	return (size_t)info.dwNumberOfProcessors;
 }
 
+std::vector<std::vector<int> > run_thread::numa_nodes()
+{
+	std::vector<std::vector<int> > nodes;
+	ULONG highest = 0;
+	if (GetNumaHighestNodeNumber(&highest))
+	{
+		for (ULONG i = 0; i <= highest; i++)
+		{
+			ULONGLONG mask = 0;
+			if (GetNumaNodeProcessorMask((UCHAR)i, &mask) && mask)
+			{
+				std::vector<int> cpus;
+				for (int j = 0; j < 64; j++)
+				{
+					if (mask & ((ULONGLONG)1 << j))
+					{
+						cpus.push_back(j);
+					}
+				}
+				nodes.push_back(std::move(cpus));
+			}
+		}
+	}
+	if (nodes.empty())
+	{
+		nodes.resize(1);
+		for (size_t i = 0; i < cpu_thread_number(); i++)
+		{
+			nodes[0].push_back((int)i);
+		}
+	}
+	return nodes;
+}
+
+bool run_thread::set_current_affinity(const std::vector<int>& cpus)
+{
+	DWORD_PTR mask = 0;
+	for (int i : cpus)
+	{
+		if (i < (int)(8 * sizeof(DWORD_PTR)))
+		{
+			mask |= (DWORD_PTR)1 << i;
+		}
+	}
+	return mask && 0 != SetThreadAffinityMask(GetCurrentThread(), mask);
+}
+
 void run_thread::sleep(int ms)
 {
 	Sleep(ms);
@@ -159,6 +206,8 @@ void** tls_space::get_space()
 #include <string>
 #include <sys/prctl.h>
 #include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 run_thread::run_thread()
 {
@@ -275,6 +324,90 @@ size_t run_thread::cpu_thread_number()
 	return (size_t)sysconf(_SC_NPROCESSORS_ONLN);
 }
 
+//sysfs"0-3,8,10-11"ʽıб
+static bool parse_sysfs_list(const char* path, std::vector<int>& res)
+{
+	std::ifstream file(path);
+	std::string line;
+	if (!getline(file, line))
+	{
+		return false;
+	}
+	size_t i = 0;
+	while (i < line.size())
+	{
+		char* end = NULL;
+		const int first = (int)strtol(line.c_str() + i, &end, 10);
+		if (end == line.c_str() + i)
+		{
+			break;
+		}
+		int last = first;
+		i = end - line.c_str();
+		if (i < line.size() && '-' == line[i])
+		{
+			last = (int)strtol(line.c_str() + i + 1, &end, 10);
+			i = end - line.c_str();
+		}
+		for (int j = first; j <= last; j++)
+		{
+			res.push_back(j);
+		}
+		if (i < line.size() && ',' == line[i])
+		{
+			i++;
+		}
+		else
+		{
+			break;
+		}
+	}
+	return !res.empty();
+}
+
+std::vector<std::vector<int> > run_thread::numa_nodes()
+{
+	std::vector<std::vector<int> > nodes;
+	std::vector<int> onlines;
+	if (parse_sysfs_list("/sys/devices/system/node/online", onlines))
+	{
+		for (int node : onlines)
+		{
+			char path[64];
+			sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+			std::vector<int> cpus;
+			//ֻڴûдĽڵ㲻
+			if (parse_sysfs_list(path, cpus))
+			{
+				nodes.push_back(std::move(cpus));
+			}
+		}
+	}
+	if (nodes.empty())
+	{
+		nodes.resize(1);
+		for (size_t i = 0; i < cpu_thread_number(); i++)
+		{
+			nodes[0].push_back((int)i);
+		}
+	}
+	return nodes;
+}
+
+bool run_thread::set_current_affinity(const std::vector<int>& cpus)
+{
+	cpu_set_t cpumask;
+	CPU_ZERO(&cpumask);
+	for (int i : cpus)
+	{
+		if (i < CPU_SETSIZE)
+		{
+			CPU_SET(i, &cpumask);
+		}
+	}
+	return 0 == pthread_setaffinity_np(pthread_self(), sizeof(cpumask), &cpumask);
+}
+
 void run_thread::sleep(int ms)
 {
 	if (ms)
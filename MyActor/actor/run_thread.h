@@ -1,6 +1,7 @@
 #ifndef __RUN_THREAD_H
 #define __RUN_THREAD_H
 
+#include <vector>
 #include "try_move.h"
 #include "scattered.h"
 #ifdef _WIN32
@@ -95,6 +96,16 @@ public:
 	static thread_id this_thread_id();
 	static size_t cpu_core_number();
 	static size_t cpu_thread_number();
+
+	/*!
+	@brief ȡNUMAڵˣÿԪΪһڵµ߼ţ޷ȡʱذȫĵڵ
+	*/
+	static std::vector<std::vector<int> > numa_nodes();
+
+	/*!
+	@brief ǰ̰߳󶨵һ߼
+	*/
+	static bool set_current_affinity(const std::vector<int>& cpus);
 	static void sleep(int ms);
 private:
 #ifdef _WIN32
@@ -24,17 +24,20 @@ struct pc_cycle
 			_sCycle = 0;
 			_msCycle = 0;
 			_usCycle = 0;
+			_nsCycle = 0;
 			assert(false);
 			return;
 		}
 		_sCycle = 1.0 / (double)frep.QuadPart;
 		_msCycle = 1000.0 / (double)frep.QuadPart;
 		_usCycle = 1000000.0 / (double)frep.QuadPart;
+		_nsCycle = 1000000000.0 / (double)frep.QuadPart;
 	}
 
 	double _sCycle;
 	double _msCycle;
 	double _usCycle;
+	double _nsCycle;
 } _pcCycle;
 #endif
 
@@ -307,6 +310,13 @@ void enable_high_resolution()
 	timeBeginPeriod(1);
 }
 
+long long get_tick_ns()
+{
+	LARGE_INTEGER quadPart;
+	QueryPerformanceCounter(&quadPart);
+	return (long long)((double)quadPart.QuadPart*_pcCycle._nsCycle);
+}
+
 long long get_tick_us()
 {
 	LARGE_INTEGER quadPart;
@@ -328,14 +338,306 @@ int get_tick_s()
 	return (int)((double)quadPart.QuadPart*_pcCycle._sCycle);
 }
 
+const char* get_tick_source()
+{
+	return "QueryPerformanceCounter";
+}
+
 #elif __linux__
 
+#if (defined ENABLE_FAST_TICK) && ((defined __x86_64__) || (defined _ARM64))
+#ifdef __x86_64__
+#include <cpuid.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+
+//CPUʱӰCLOCK_MONOTONICУʵļ
+#ifndef FAST_TICK_SYNC_MS
+#define FAST_TICK_SYNC_MS 500
+#endif
+
+//״ζʱӺ󾭹ʼʣǰʱclock_gettime
+#ifndef FAST_TICK_CALIBRATE_MS
+#define FAST_TICK_CALIBRATE_MS 10
+#endif
+
+/*!
+@brief CPUʱ(x86-64TSCARM64 cntvct)CLOCK_MONOTONICΪ׼㣬
+״ʹʱſʼУ׼ھ̬ʼеȴÿFAST_TICK_SYNC_MSɶʱӵ߳˳УһʣУǰʱˣ
+˻CLOCK_MONOTONICƫʱ½׼(ǰʱͣס)ʱֹرգget_tick_*˵clock_gettime
+*/
+class FastTick_
+{
+	enum
+	{
+		state_idle = 0,//δʹã̬洢ʼΪ0
+		state_busy,//ĳ߳У׼
+		state_based,//Ѽ¼У׼
+		state_enabled,
+		state_disabled
+	};
+public:
+	bool enabled()
+	{
+		int state = _state.load(std::memory_order_acquire);
+		return state_enabled == state || (state_enabled > state && calibrate(state));
+	}
+
+	long long get_ns()
+	{
+		const unsigned long long counter = read_counter();
+		unsigned seq;
+		unsigned long long anchorCounter, mult;
+		long long anchorNs;
+		do
+		{
+			seq = _seq.load(std::memory_order_acquire);
+			anchorCounter = _anchorCounter.load(std::memory_order_relaxed);
+			anchorNs = _anchorNs.load(std::memory_order_relaxed);
+			mult = _mult.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+		} while ((seq & 1) || seq != _seq.load(std::memory_order_relaxed));
+		if (counter <= anchorCounter)
+		{
+			if (anchorCounter - counter > _syncTicks / 64)
+			{//(ָ)½׼CLOCK_MONOTONIC
+				sync();
+				return std::max(sys_ns(), anchorNs);
+			}
+			//̵߳Уȡ
+			return anchorNs;
+		}
+		const unsigned long long delta = counter - anchorCounter;
+		if (delta >= _syncTicks)
+		{
+			sync();
+		}
+		return anchorNs + (long long)(((unsigned __int128)delta * mult) >> 32);
+	}
+private:
+	/*!
+	@brief ״εü¼㣬֮һFAST_TICK_CALIBRATE_MSʱӵ߳ʲ
+	̺߳δʱĵֱӷfalseclock_gettime
+	*/
+	bool calibrate(int state)
+	{
+		if (state_busy == state || !_state.compare_exchange_strong(state, state_busy, std::memory_order_acquire))
+		{
+			return false;
+		}
+		int next = state;
+		if (state_idle == state)
+		{
+			if (usable())
+			{
+				read_pair(_baseCounter, _baseNs);
+				next = state_based;
+			}
+			else
+			{
+				next = state_disabled;
+			}
+		}
+		else if (sys_ns() - _baseNs >= (long long)FAST_TICK_CALIBRATE_MS * 1000000)
+		{
+			unsigned long long c1;
+			long long n1;
+			read_pair(c1, n1);
+			if (c1 <= _baseCounter || n1 <= _baseNs)
+			{
+				next = state_disabled;
+			}
+			else
+			{
+				const unsigned long long rate = (unsigned long long)(((unsigned __int128)(n1 - _baseNs) << 32) / (c1 - _baseCounter));
+				_syncTicks = (unsigned long long)(((unsigned __int128)FAST_TICK_SYNC_MS * 1000000 << 32) / rate);
+				_anchorCounter = c1;
+				_anchorNs = n1;
+				_mult = rate;
+				_rate = rate;
+				next = state_enabled;
+			}
+		}
+		_state.store(next, std::memory_order_release);
+		return state_enabled == next;
+	}
+
+	static bool usable()
+	{
+#ifdef __x86_64__
+		//Ҫ󲻱TSCںԼҲtscΪʱԴ(˵TSCͬ¿)
+		unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+		if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1 << 8)))
+		{
+			return false;
+		}
+		std::ifstream clockSource("/sys/devices/system/clocksource/clocksource0/current_clocksource");
+		std::string name;
+		return clockSource >> name && "tsc" == name;
+#else
+		return true;
+#endif
+	}
+
+	static unsigned long long read_counter()
+	{
+#ifdef __x86_64__
+		unsigned int lo, hi;
+		__asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+		return ((unsigned long long)hi << 32) | lo;
+#else
+		unsigned long long res;
+		__asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r" (res) :: "memory");
+		return res;
+#endif
+	}
+
+	static long long sys_ns()
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+	}
+
+	/*!
+	@brief ͬʱȡCLOCK_MONOTONICظȡǰСһΣⱻռĶӰ컻
+	*/
+	static void read_pair(unsigned long long& counter, long long& ns)
+	{
+		unsigned long long minSpan = (unsigned long long)-1;
+		for (int i = 0; i < 8; i++)
+		{
+			const unsigned long long c0 = read_counter();
+			const long long n = sys_ns();
+			const unsigned long long c1 = read_counter();
+			if (c1 - c0 < minSpan)
+			{
+				minSpan = c1 - c0;
+				counter = c0 + (c1 - c0) / 2;
+				ns = n;
+			}
+		}
+	}
+
+	void sync()
+	{
+		bool syncing = false;
+		if (!_syncing.compare_exchange_strong(syncing, true))
+		{
+			return;
+		}
+		unsigned long long counter;
+		long long ns;
+		read_pair(counter, ns);
+		const unsigned long long anchorCounter = _anchorCounter.load(std::memory_order_relaxed);
+		const long long oldAnchorNs = _anchorNs.load(std::memory_order_relaxed);
+		if (counter > anchorCounter)
+		{
+			//êȡԭֵٵʹһУ׷ƽCLOCK_MONOTONIC
+			const long long curNs = oldAnchorNs +
+				(long long)(((unsigned __int128)(counter - anchorCounter) * _mult.load(std::memory_order_relaxed)) >> 32);
+			long long anchorNs = curNs;
+			unsigned long long mult;
+			if (ns - curNs > 1000000 || curNs - ns > 1000000)
+			{//ƫ1ms(ָʱCLOCK_MONOTONICֻһ)׼ѲţԵǰ½׼ϴεĹ
+				_baseCounter = counter;
+				_baseNs = ns;
+				const long long targetNs = ns + (long long)(((unsigned __int128)_syncTicks * _rate) >> 32);
+				if (ns > curNs)
+				{//ֱ׷
+					anchorNs = ns;
+					mult = _rate;
+				}
+				else if (targetNs > curNs)
+				{//ǰһУCLOCK_MONOTONICغ
+					mult = (unsigned long long)(((unsigned __int128)(targetNs - curNs) << 32) / _syncTicks);
+				}
+				else
+				{//ǰһУϣͣסCLOCK_MONOTONIC׷
+					mult = 0;
+				}
+			}
+			else
+			{
+				const unsigned long long rate = (unsigned long long)(((unsigned __int128)(ns - _baseNs) << 32) / (counter - _baseCounter));
+				const long long targetNs = ns + (long long)(((unsigned __int128)_syncTicks * rate) >> 32);
+				_rate = rate;
+				if (targetNs > curNs)
+				{
+					mult = (unsigned long long)(((unsigned __int128)(targetNs - curNs) << 32) / _syncTicks);
+					mult = std::min(std::max(mult, rate - rate / 1000), rate + rate / 1000);
+				}
+				else
+				{
+					mult = rate - rate / 1000;
+				}
+			}
+			publish(counter, anchorNs, mult);
+		}
+		else if (anchorCounter - counter > _syncTicks / 64)
+		{//ˣԵǰΪµĻ׼ê㣬ãֵ
+			_baseCounter = counter;
+			_baseNs = ns;
+			publish(counter, std::max(ns, oldAnchorNs), _rate);
+		}
+		_syncing = false;
+	}
+
+	void publish(unsigned long long anchorCounter, long long anchorNs, unsigned long long mult)
+	{
+		const unsigned seq = _seq.load(std::memory_order_relaxed);
+		_seq.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		_anchorCounter.store(anchorCounter, std::memory_order_relaxed);
+		_anchorNs.store(anchorNs, std::memory_order_relaxed);
+		_mult.store(mult, std::memory_order_relaxed);
+		_seq.store(seq + 2, std::memory_order_release);
+	}
+private:
+	std::atomic<unsigned> _seq;
+	std::atomic<unsigned long long> _anchorCounter;
+	std::atomic<long long> _anchorNs;
+	std::atomic<unsigned long long> _mult;//ÿ32λС
+	unsigned long long _rate;//һɻ׼ƵʣΪ׷ƽƫĵ
+	std::atomic<bool> _syncing;
+	unsigned long long _baseCounter;
+	long long _baseNs;
+	unsigned long long _syncTicks;
+	std::atomic<int> _state;
+};
+
+//ûй캯̬洢ԱΪ0״ζʱʱУ׼
+static FastTick_ s_fastTick;
+#define FAST_TICK_COUNTER
+#endif
+
 void enable_high_resolution()
 {
 }
 
+long long get_tick_ns()
+{
+#ifdef FAST_TICK_COUNTER
+	if (s_fastTick.enabled())
+	{
+		return s_fastTick.get_ns();
+	}
+#endif
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
 long long get_tick_us()
 {
+#ifdef FAST_TICK_COUNTER
+	if (s_fastTick.enabled())
+	{
+		return s_fastTick.get_ns() / 1000;
+	}
+#endif
 	struct timespec ts;
 	clock_gettime(CLOCK_MONOTONIC, &ts);
 	return (long long)ts.tv_sec * 1000000 + ts.tv_nsec/1000;
@@ -343,6 +645,12 @@ long long get_tick_us()
 
 long long get_tick_ms()
 {
+#ifdef FAST_TICK_COUNTER
+	if (s_fastTick.enabled())
+	{
+		return s_fastTick.get_ns() / 1000000;
+	}
+#endif
 	struct timespec ts;
 	clock_gettime(CLOCK_MONOTONIC, &ts);
 	return (long long)ts.tv_sec * 1000 + ts.tv_nsec/1000000;
@@ -350,11 +658,32 @@ long long get_tick_ms()
 
 int get_tick_s()
 {
+#ifdef FAST_TICK_COUNTER
+	if (s_fastTick.enabled())
+	{
+		return (int)(s_fastTick.get_ns() / 1000000000);
+	}
+#endif
 	struct timespec ts;
 	clock_gettime(CLOCK_MONOTONIC, &ts);
 	return (int)ts.tv_sec;
 }
 
+const char* get_tick_source()
+{
+#ifdef FAST_TICK_COUNTER
+	if (s_fastTick.enabled())
+	{
+#ifdef __x86_64__
+		return "tsc";
+#else
+		return "cntvct";
+#endif
+	}
+#endif
+	return "clock_gettime";
+}
+
 #endif
 
 #ifdef __GNUG__
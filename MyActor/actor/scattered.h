@@ -393,10 +393,16 @@ void print_time_us(std::wostream&);
 void print_time_ms(std::wostream&);
 void print_time_s(std::wostream&);
 
+long long get_tick_ns();
 long long get_tick_us();
 long long get_tick_ms();
 int get_tick_s();
 
+/*!
+@brief get_tick_*ǰʹõʱԴ(ENABLE_FAST_TICK¿Ϊtsc/cntvct)
+*/
+const char* get_tick_source();
+
 #ifdef _MSC_VER
 extern "C" void* __fastcall get_sp();
 extern "C" unsigned long long __fastcall cpu_tick();
@@ -405,6 +411,14 @@ void* get_sp();
 unsigned long long cpu_tick();
 #endif
 
+/*!
+@brief ַɢУַ룬λΪ0ɢȡģڰַƬ
+*/
+inline size_t address_hash(const void* p)
+{
+	return (size_t)((((unsigned long long)(size_t)p >> 4) * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
 /*!
 @brief ͣ""һ͵hash_codeԱtypeid(type).hash_code()
 */
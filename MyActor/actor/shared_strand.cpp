@@ -1,11 +1,14 @@
 #include "shared_strand.h"
 #include "actor_timer.h"
 #include "async_timer.h"
+#include "check_actor_stack.h"
 
 #define NEXT_TICK_SPACE_SIZE (sizeof(void*)*8)
 
+std::atomic<long long> boost_strand::_defaultTimerSlack(0);
+
 boost_strand::boost_strand()
-:_ioEngine(NULL), _strand(NULL), _actorTimer(NULL)
+:_ioEngine(NULL), _strand(NULL), _actorTimer(NULL), _timerSlack(-1)
 #ifdef ENABLE_NEXT_TICK
 ,_thisRoundCount(0)
 ,_reuMemAlloc(NULL)
@@ -39,24 +42,91 @@ boost_strand::~boost_strand()
 
 shared_strand boost_strand::create(io_engine& ioEngine)
 {
+	if (io_engine::sharded == ioEngine.engineMode() && ioEngine._opend)
+	{
+		//Ƭģʽ䵽Ƭrun֮ǰƬδڹ_ios(0Ƭ)
+		return create_pinned(ioEngine, ioEngine.nextShard(-1));
+	}
 	shared_strand res = ioEngine._strandPool->pick();
 	res->_weakThis = res;
+	res->_timerSlack = -1;
 	if (!res->_ioEngine)
 	{
-		res->_ioEngine = &ioEngine;
-		res->_strand = new strand_type(ioEngine);
-#ifdef ENABLE_NEXT_TICK
-		res->_reuMemAlloc = new reusable_mem();
-		res->_nextTickAlloc[0] = new mem_alloc2<char[NEXT_TICK_SPACE_SIZE]>(ioEngine._poolSize);
-		res->_nextTickAlloc[1] = new mem_alloc2<char[NEXT_TICK_SPACE_SIZE * 2]>(ioEngine._poolSize / 2);
-		res->_nextTickAlloc[2] = new mem_alloc2<char[NEXT_TICK_SPACE_SIZE * 4]>(ioEngine._poolSize / 4);
-#endif
-		res->_actorTimer = new ActorTimer_(res);
-		res->_overTimer = new overlap_timer(res);
+		res->init(ioEngine, ioEngine);
+	}
+	return res;
+}
+
+shared_strand boost_strand::create_pinned(io_engine& ioEngine, size_t threadIndex)
+{
+	if (io_engine::asio_strand == ioEngine.engineMode() || !ioEngine._opend || threadIndex >= ioEngine._pinnedStrandPool.size())
+	{//run֮ǰ̺߳ԽʱûжӦĵ̣߳˻Ϊͨstrand
+		assert(io_engine::asio_strand == ioEngine.engineMode() || !ioEngine._opend);
+		return create(ioEngine);
+	}
+	shared_strand res = ioEngine._pinnedStrandPool[threadIndex]->pick();
+	res->_weakThis = res;
+	res->_timerSlack = -1;
+	if (!res->_ioEngine)
+	{
+		res->init(ioEngine, ioEngine.shardService(threadIndex));
+		res->_strand->pin(threadIndex);
+	}
+	return res;
+}
+
+shared_strand boost_strand::create(io_engine& ioEngine, size_t numaNode)
+{
+	if (io_engine::asio_strand == ioEngine.engineMode() || !ioEngine._opend || 1 == ioEngine.numaNodes())
+	{
+		return create(ioEngine);
+	}
+	assert(numaNode < ioEngine.numaNodes());
+	if (io_engine::sharded == ioEngine.engineMode())
+	{
+		return create_pinned(ioEngine, ioEngine.nextShard(numaNode));
+	}
+	shared_strand res = ioEngine._nodeStrandPool[numaNode]->pick();
+	res->_weakThis = res;
+	res->_timerSlack = -1;
+	if (!res->_ioEngine)
+	{
+		res->init(ioEngine, ioEngine);
+		res->_strand->bind_node(numaNode);
 	}
 	return res;
 }
 
+shared_strand boost_strand::create_class(io_engine& ioEngine, strand_class cls)
+{
+	if (strand_normal == cls || io_engine::sharded == ioEngine.engineMode())
+	{
+		return create(ioEngine);
+	}
+	assert(cls < strand_class_num);
+	shared_strand res = ioEngine._classStrandPool[cls]->pick();
+	res->_weakThis = res;
+	res->_timerSlack = -1;
+	if (!res->_ioEngine)
+	{
+		res->init(ioEngine, ioEngine);
+		res->_strand->set_class(cls);
+	}
+	return res;
+}
+
+void boost_strand::init(io_engine& ioEngine, boost::asio::io_service& ios)
+{
+	_ioEngine = &ioEngine;
+	_strand = new strand_type(ioEngine, ios);
+#ifdef ENABLE_NEXT_TICK
+	_reuMemAlloc = new reusable_mem();
+#endif
+	shared_strand self = _weakThis.lock();
+	_actorTimer = new ActorTimer_(self);
+	_overTimer = new overlap_timer(self);
+}
+
 std::vector<shared_strand> boost_strand::create_multi(size_t n, io_engine& ioEngine)
 {
 	assert(0 != n);
@@ -165,7 +235,7 @@ io_engine& boost_strand::get_io_engine()
 boost::asio::io_service& boost_strand::get_io_service()
 {
 	assert(_ioEngine);
-	return *_ioEngine;
+	return _strand ? _strand->_ios : (boost::asio::io_service&)*_ioEngine;
 }
 
 ActorTimer_* boost_strand::actor_timer()
@@ -178,6 +248,41 @@ overlap_timer* boost_strand::over_timer()
 	return _overTimer;
 }
 
+void boost_strand::timer_slack(long long us)
+{
+	_timerSlack = us;
+}
+
+long long boost_strand::timer_slack()
+{
+	return _timerSlack;
+}
+
+void boost_strand::default_timer_slack(long long us)
+{
+	_defaultTimerSlack = us;
+}
+
+long long boost_strand::slack_deadline(long long et, long long slack)
+{
+	if (slack < 0)
+	{
+		slack = _timerSlack >= 0 ? _timerSlack : _defaultTimerSlack.load(std::memory_order_relaxed);
+	}
+	if (slack > 1 && et > 0)
+	{//ȡݲstrandͬһʱ
+		return (et + slack - 1) / slack * slack;
+	}
+	return et;
+}
+
+#ifdef ENABLE_STRAND_STATS
+strand_stats boost_strand::stats(bool reset)
+{
+	return _strand ? _strand->stats(reset) : strand_stats();
+}
+#endif
+
 std::shared_ptr<AsyncTimer_> boost_strand::make_timer()
 {
 	std::shared_ptr<AsyncTimer_> res = std::make_shared<AsyncTimer_>(_actorTimer);
@@ -200,6 +305,9 @@ bool boost_strand::waiting_empty()
 
 void boost_strand::push_next_tick(wrap_next_tick_face* handler)
 {
+#ifdef ENABLE_STRAND_STATS
+	handler->_postTick = get_tick_ns();
+#endif
 	_backTickQueue.push_back(handler);
 }
 
@@ -212,6 +320,9 @@ void boost_strand::run_tick_front()
 	while (!_frontTickQueue.empty())
 	{
 		wrap_next_tick_face* const tick = static_cast<wrap_next_tick_face*>(_frontTickQueue.pop_front());
+#ifdef ENABLE_STRAND_STATS
+		_strand->stats_sink().queue_wait(get_tick_ns() - tick->_postTick);
+#endif
 		const size_t spaceSize = tick->invoke();
 		switch (MEM_ALIGN(spaceSize, NEXT_TICK_SPACE_SIZE) / NEXT_TICK_SPACE_SIZE)
 		{
@@ -232,9 +343,15 @@ void boost_strand::run_tick_back()
 	}
 	size_t tickCount = _thisRoundCount;
 	_thisRoundCount = 0;
+#ifdef ENABLE_STRAND_STATS
+	_strand->stats_sink().round_ticks(tickCount);
+#endif
 	while (!_backTickQueue.empty() && tickCount--)
 	{
 		wrap_next_tick_face* const tick = static_cast<wrap_next_tick_face*>(_backTickQueue.pop_front());
+#ifdef ENABLE_STRAND_STATS
+		_strand->stats_sink().queue_wait(get_tick_ns() - tick->_postTick);
+#endif
 		const size_t spaceSize = tick->invoke();
 		switch (MEM_ALIGN(spaceSize, NEXT_TICK_SPACE_SIZE) / NEXT_TICK_SPACE_SIZE)
 		{
@@ -256,6 +373,13 @@ void boost_strand::run_tick_back()
 
 void* boost_strand::alloc_space(size_t size)
 {
+	if (!_nextTickAlloc[0])
+	{
+		//ӳٵstrandִ߳״ʹʱʹڴ״ηstrandڵĽڵ
+		_nextTickAlloc[0] = new mem_alloc2<char[NEXT_TICK_SPACE_SIZE]>(_ioEngine->_poolSize);
+		_nextTickAlloc[1] = new mem_alloc2<char[NEXT_TICK_SPACE_SIZE * 2]>(_ioEngine->_poolSize / 2);
+		_nextTickAlloc[2] = new mem_alloc2<char[NEXT_TICK_SPACE_SIZE * 4]>(_ioEngine->_poolSize / 4);
+	}
 	switch (MEM_ALIGN(size, NEXT_TICK_SPACE_SIZE) / NEXT_TICK_SPACE_SIZE)
 	{
 	case 1: return !_nextTickAlloc[0]->overflow() ? _nextTickAlloc[0]->allocate() : NULL;
@@ -265,4 +389,78 @@ void* boost_strand::alloc_space(size_t size)
 	return NULL;
 }
 
-#endif //ENABLE_NEXT_TICK
\ No newline at end of file
+#endif //ENABLE_NEXT_TICK
+
+//////////////////////////////////////////////////////////////////////////
+
+post_batch_scope::post_batch_scope()
+:_installed(false)
+{
+	void** const tlsBuff = io_engine::getTlsValueBuff();
+	if (tlsBuff && !tlsBuff[POST_BATCH_INDEX])
+	{
+		tlsBuff[POST_BATCH_INDEX] = this;
+		_installed = true;
+	}
+}
+
+post_batch_scope::~post_batch_scope()
+{
+	if (_installed)
+	{
+		flush();
+		io_engine::setTlsValue(POST_BATCH_INDEX, NULL);
+	}
+	assert(_items.empty());
+}
+
+post_batch_scope* post_batch_scope::current()
+{
+	void** const tlsBuff = io_engine::getTlsValueBuff();
+	if (tlsBuff)
+	{
+		return (post_batch_scope*)tlsBuff[POST_BATCH_INDEX];
+	}
+	return NULL;
+}
+
+void post_batch_scope::append(shared_strand&& strand, StrandEx_::wrap_handler_face* handler)
+{
+	assert(_installed);
+	batch_item item = { std::move(strand), handler };
+	_items.push_back(std::move(item));
+}
+
+void post_batch_scope::flush()
+{
+	if (_items.empty())
+	{
+		return;
+	}
+	//strand飬ͬһstrandڱͶ˳
+	std::stable_sort(_items.begin(), _items.end(), [](const batch_item& a, const batch_item& b)
+	{
+		return a._strand.get() < b._strand.get();
+	});
+	for (size_t i = 0; i < _items.size();)
+	{
+		StrandEx_* const strand = _items[i]._strand->_strand;
+		op_queue tasks;
+		size_t j = i;
+		for (; j < _items.size() && strand == _items[j]._strand->_strand; j++)
+		{
+			tasks.push_back(_items[j]._handler);
+		}
+		if (strand->append_tasks(tasks))
+		{
+			_readyStrands.push_back(strand);
+		}
+		i = j;
+	}
+	if (!_readyStrands.empty())
+	{
+		StrandEx_::schedule_batch(_readyStrands);
+		_readyStrands.clear();
+	}
+	_items.clear();
+}
\ No newline at end of file
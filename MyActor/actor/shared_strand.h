@@ -81,7 +81,49 @@ else\
 	post_choose(std::forward<Handler>(handler)); \
 }
 
-#ifdef DISABLE_BOOST_TIMER
+/*!
+@brief Ͷڱ߳̾boost_strand::post_batchͶݵĿstrand飬
+(flush)ʱÿstrandֻһͬеstrandϲȣ
+ڵpostҲһݴ棬ͬһstrandͶݱȺ˳ǶʱڲЧ
+ڿactor(actorʱ򲻿ɼ)ڲгactor
+*/
+class post_batch_scope
+{
+	friend boost_strand;
+
+	struct batch_item
+	{
+		shared_strand _strand;
+		StrandEx_::wrap_handler_face* _handler;
+	};
+public:
+	post_batch_scope();
+	~post_batch_scope();
+public:
+	/*!
+	@brief ύݴ
+	*/
+	void flush();
+
+	/*!
+	@brief ǰ߳ЧͶ
+	*/
+	static post_batch_scope* current();
+private:
+	void append(shared_strand&& strand, StrandEx_::wrap_handler_face* handler);
+private:
+	std::vector<batch_item> _items;
+	std::vector<StrandEx_*> _readyStrands;
+	bool _installed;
+	NONE_COPY(post_batch_scope);
+};
+
+//strandʱֱӳasioʱwaitable_timerʱص¼
+#if (defined DISABLE_BOOST_TIMER) || (defined ENABLE_SHARED_TIMER)
+#define TIMER_COMPLETED_EVENT
+#endif
+
+#ifdef TIMER_COMPLETED_EVENT
 struct TimerBoostCompletedEventFace_
 {
 	virtual void post_event(int tc) = 0;
@@ -119,6 +161,9 @@ class boost_strand
 	struct wrap_next_tick_face : public op_queue::face
 	{
 		virtual size_t invoke() = 0;
+#ifdef ENABLE_STRAND_STATS
+		long long _postTick;
+#endif
 	};
 
 	template <typename Handler, bool NtSpace>
@@ -213,6 +258,7 @@ class boost_strand
 	friend io_engine;
 	friend ActorTimer_;
 	friend AsyncTimer_;
+	friend post_batch_scope;
 protected:
 	enum strand_choose
 	{
@@ -233,6 +279,24 @@ public:
 	static void create_multi(shared_strand* res, size_t n, io_engine& ioEngine);
 	static void create_multi(std::vector<shared_strand>& res, size_t n, io_engine& ioEngine);
 	static void create_multi(std::list<shared_strand>& res, size_t n, io_engine& ioEngine);
+
+	/*!
+	@brief һʼڵthreadIndexִ߳еstrand߳Ͷͬ
+	߳̾Ͷ(work_stealģʽЧshardedģʽ¼ָƬasio_strandģʽ¡run֮ǰthreadIndexԽʱͬcreate)
+	*/
+	static shared_strand create_pinned(io_engine& ioEngine, size_t threadIndex);
+
+	/*!
+	@brief һֻnumaNodeڵĵִ߳еstrand(runNumawork_steal/shardedģʽЧͬcreate)
+	*/
+	static shared_strand create(io_engine& ioEngine, size_t numaNode);
+
+	/*!
+	@brief һָȼstrandȼڵȼȣȼִУ
+	߳ȼrunPriority޹أֻͬһstrand֮Ⱥ(shardedģʽºȼ
+	asio_strandģʽͨstrandֱͶݵio_serviceֻڷͨȼstrand֮)
+	*/
+	static shared_strand create_class(io_engine& ioEngine, strand_class cls);
 public:
 	/*!
 	@brief ڱstrandеֱִУӵеȴִ
@@ -270,6 +334,12 @@ public:
 	template <typename Handler>
 	void post(Handler&& handler)
 	{
+		post_batch_scope* const scope = _strand ? post_batch_scope::current() : NULL;
+		if (scope)
+		{//̴߳post_batch_scopeʱݴ棬ʱ뷢ͬһstrandͶ˳һ
+			scope->append(_weakThis.lock(), _strand->make_wrap_handler(RUN_HANDLER, false));
+			return;
+		}
 #if (ENABLE_QT_ACTOR || ENABLE_UV_ACTOR)
 		CHOOSE_POST();
 #else
@@ -277,6 +347,15 @@ public:
 #endif
 	}
 
+	/*!
+	@brief ͬpostڵpostѾstrandݴ棬˽ӿڱͶݵĵõ
+	*/
+	template <typename Handler>
+	void post_batch(Handler&& handler)
+	{
+		post(std::forward<Handler>(handler));
+	}
+
 	/*!
 	@brief һ tick 
 	*/
@@ -453,7 +532,7 @@ public:
 	io_engine& get_io_engine();
 
 	/*!
-	@brief ȡǰ
+	@brief ȡǰ(shardedģʽΪstrandڷƬ)
 	*/
 	boost::asio::io_service& get_io_service();
 
@@ -466,11 +545,38 @@ public:
 	@brief ȡصʱ
 	*/
 	overlap_timer* over_timer();
+
+	/*!
+	@brief ñstrand϶ʱĺϲݲ(΢)ƳusĶʱͬһλд
+	-1ʹȫĬֵstrandе
+	*/
+	void timer_slack(long long us);
+	long long timer_slack();
+
+	/*!
+	@brief ȫĬ϶ʱϲݲ(΢)0Ϊϲ
+	*/
+	static void default_timer_slack(long long us);
+
+#ifdef ENABLE_STRAND_STATS
+	/*!
+	@brief ȡstrandĵͳ(еȴʱ䡢ִʱ䡢ÿ)̵߳ã
+	״εʱſʼͳƱstrand(ؿͳ)δùstrandռͳƿռ
+	@param reset ȡ
+	*/
+	strand_stats stats(bool reset = false);
+#endif
 private:
 	/*!
 	@brief ȡActorʱ
 	*/
 	ActorTimer_* actor_timer();
+	void init(io_engine& ioEngine, boost::asio::io_service& ios);
+
+	/*!
+	@brief ϲݲƳٶʱޣslackΪ-1ʱȡstrandȫ
+	*/
+	long long slack_deadline(long long et, long long slack);
 #ifdef ENABLE_QT_ACTOR
 	template <typename Handler>
 	void post_ui(Handler&& handler);
@@ -548,6 +654,8 @@ protected:
 	io_engine* _ioEngine;
 	strand_type* _strand;
 	std::weak_ptr<boost_strand> _weakThis;
+	long long _timerSlack;
+	static std::atomic<long long> _defaultTimerSlack;
 	NONE_COPY(boost_strand);
 public:
 	/*!
@@ -0,0 +1,157 @@
+#if (defined ENABLE_SHARED_TIMER) && !(defined DISABLE_BOOST_TIMER)
+#include "shared_timer.h"
+#include "scattered.h"
+#include "io_engine.h"
+#ifdef DISABLE_HIGH_TIMER
+#include <boost/asio/deadline_timer.hpp>
+typedef boost::asio::deadline_timer shared_timer_type;
+#else
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/asio/high_resolution_timer.hpp>
+typedef boost::asio::basic_waitable_timer<boost::chrono::high_resolution_clock> shared_timer_type;
+#endif
+
+SharedTimer_::SharedTimer_(boost::asio::io_service& ios)
+:_ios(ios), _timer(new shared_timer_type(ios)), _extMaxTick(0), _extFinishTime(-1), _eventsQueue(MEM_POOL_LENGTH), _timerCount(0) {}
+
+SharedTimer_::~SharedTimer_()
+{
+	assert(_eventsQueue.empty());
+	delete (shared_timer_type*)_timer;
+}
+
+void SharedTimer_::appendEvent(long long abs, long long rel, SharedTimerEvent_* h)
+{
+	assert(h->_timerHandle._null);
+	h->_timerHandle._null = false;
+	std::lock_guard<std::mutex> lg(_ctrlMutex);
+	if (abs >= _extMaxTick)
+	{
+		_extMaxTick = abs;
+		h->_timerHandle._queueNode = _eventsQueue.insert(_eventsQueue.end(), std::make_pair(abs, h));
+	}
+	else
+	{
+		h->_timerHandle._queueNode = _eventsQueue.insert(std::make_pair(abs, h));
+	}
+	if ((unsigned long long)abs < (unsigned long long)_extFinishTime)
+	{//ڵǰ޲asioʱʱԭȴoperation_abortedɲ
+		_extFinishTime = abs;
+		timer_loop(abs, rel);
+	}
+}
+
+void SharedTimer_::removeEvent(timer_handle& th)
+{
+	std::lock_guard<std::mutex> lg(_ctrlMutex);
+	if (!th._null)
+	{
+		th._null = true;
+		auto itNode = th._queueNode;
+		if (_eventsQueue.size() == 1)
+		{//ûеȴʱȡasioʱռסio_service
+			_extMaxTick = 0;
+			_extFinishTime = -1;
+			_eventsQueue.erase(itNode);
+			_timerCount++;
+			boost::system::error_code ec;
+			as_ptype<shared_timer_type>(_timer)->cancel(ec);
+		}
+		else if (itNode->first == _extMaxTick)
+		{
+			_eventsQueue.erase(itNode++);
+			if (_eventsQueue.end() == itNode)
+			{
+				itNode--;
+			}
+			_extMaxTick = itNode->first;
+		}
+		else
+		{
+			_eventsQueue.erase(itNode);
+		}
+	}
+}
+
+void SharedTimer_::timer_loop(long long abs, long long rel)
+{
+	int tc = ++_timerCount;
+	boost::system::error_code ec;
+#ifdef DISABLE_HIGH_TIMER
+	as_ptype<shared_timer_type>(_timer)->expires_from_now(boost::posix_time::microseconds(rel), ec);
+#else
+	as_ptype<shared_timer_type>(_timer)->expires_at(shared_timer_type::time_point(boost::chrono::microseconds(abs)), ec);
+#endif
+	as_ptype<shared_timer_type>(_timer)->async_wait([this, tc](const boost::system::error_code&)
+	{
+		event_handler(tc);
+	});
+}
+
+void SharedTimer_::event_handler(int tc)
+{
+	//ͷύڵstrandʱstrandϲ
+	post_batch_scope batchScope;
+	std::lock_guard<std::mutex> lg(_ctrlMutex);
+	if (tc == _timerCount)
+	{
+		_extFinishTime = -1;
+		long long ct = get_tick_us();
+		while (!_eventsQueue.empty())
+		{
+			handler_queue::iterator iter = _eventsQueue.begin();
+			if (iter->first > ct)
+			{
+				_extFinishTime = iter->first;
+				timer_loop(_extFinishTime, _extFinishTime - ct);
+				break;
+			}
+			else
+			{
+				iter->second->eventHandler();
+				_eventsQueue.erase(iter);
+			}
+		}
+		if (_eventsQueue.empty())
+		{
+			_extMaxTick = 0;
+		}
+	}
+}
+//////////////////////////////////////////////////////////////////////////
+
+SharedTimerEvent_::SharedTimerEvent_(io_engine& engine, boost::asio::io_service& ios, TimerBoostCompletedEventFace_* timerBoost)
+:_timer(engine.sharedTimer(ios, timerBoost)), _timerBoost(timerBoost), _tcId(-1), _triged(true) {}
+
+SharedTimerEvent_::~SharedTimerEvent_()
+{
+	assert(_triged);
+}
+
+void SharedTimerEvent_::eventHandler()
+{
+	_timerHandle.reset();
+	_triged = true;
+	_timerBoost->post_event(_tcId);
+}
+
+void SharedTimerEvent_::cancel(boost::system::error_code& ec)
+{
+	ec.clear();
+	_timer->removeEvent(_timerHandle);
+	if (!_triged)
+	{
+		_triged = true;
+		_timerBoost->cancel_event();
+	}
+}
+
+void SharedTimerEvent_::async_wait(long long abs, long long rel, int tc)
+{
+	assert(_triged);
+	_triged = false;
+	_tcId = tc;
+	_timer->appendEvent(abs, rel, this);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef __SHARED_TIMER_H
+#define __SHARED_TIMER_H
+
+#if (defined ENABLE_SHARED_TIMER) && !(defined DISABLE_BOOST_TIMER)
+#include <mutex>
+#include "msg_queue.h"
+#include "run_strand.h"
+
+//̹߳õio_serviceϹʱķstrandʱֵַݣÿԼasioʱ
+#ifndef SHARED_TIMER_STRIPES
+#define SHARED_TIMER_STRIPES 8
+#endif
+
+class ActorTimer_;
+class SharedTimerEvent_;
+class overlap_timer;
+
+/*!
+@brief ʱͬһio_service(Ƭ)ϵstrandʱasioʱ޶У
+ÿstrandʱڶһ()ںͶݻظstrand
+ֻasioʱstrandʱԼ޶к͵Ǽ԰strand
+*/
+class SharedTimer_
+{
+	typedef msg_multimap<long long, SharedTimerEvent_*> handler_queue;
+
+	struct timer_handle
+	{
+		void reset()
+		{
+			_null = true;
+		}
+
+		bool _null = true;
+		handler_queue::iterator _queueNode;
+	};
+
+	friend io_engine;
+	friend SharedTimerEvent_;
+private:
+	SharedTimer_(boost::asio::io_service& ios);
+	~SharedTimer_();
+private:
+	void appendEvent(long long abs, long long rel, SharedTimerEvent_* h);
+	void removeEvent(timer_handle& th);
+	void timer_loop(long long abs, long long rel);
+	void event_handler(int tc);
+private:
+	boost::asio::io_service& _ios;
+	void* _timer;
+	long long _extMaxTick;
+	long long _extFinishTime;
+	handler_queue _eventsQueue;
+	std::mutex _ctrlMutex;
+	int _timerCount;
+	NONE_COPY(SharedTimer_);
+};
+
+/*!
+@brief strandʱڹʱеĵǼ
+*/
+class SharedTimerEvent_
+{
+	friend ActorTimer_;
+	friend SharedTimer_;
+	friend overlap_timer;
+private:
+	SharedTimerEvent_(io_engine& engine, boost::asio::io_service& ios, TimerBoostCompletedEventFace_* timerBoost);
+	~SharedTimerEvent_();
+private:
+	void eventHandler();
+	void cancel(boost::system::error_code& ec);
+	void async_wait(long long abs, long long rel, int tc);
+private:
+	SharedTimer_* const _timer;
+	SharedTimer_::timer_handle _timerHandle;
+	TimerBoostCompletedEventFace_* _timerBoost;
+	int _tcId;
+	bool _triged;
+	NONE_COPY(SharedTimerEvent_);
+};
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,762 @@
+#include "steal_scheduler.h"
+#include "strand_ex.h"
+#include "io_engine.h"
+#include "check_actor_stack.h"
+
+StealScheduler_::worker::worker(StealScheduler_* owner, size_t index)
+:_owner(owner), _index(index), _node(0), _readyCount(0), _parked(false), _wakeup(false), _stealSeed(index), _tick(0), _retire(false), _retired(false), _forward(NULL), _realtimeRun(0), _normalRun(0) {}
+
+StealScheduler_::worker::~worker()
+{
+	assert(_readyQueue.empty());
+	assert(_pinnedQueue.empty());
+	assert(0 == _readyCount);
+}
+//////////////////////////////////////////////////////////////////////////
+
+StealScheduler_::inject_queue::inject_queue()
+:_count(0) {}
+
+StealScheduler_::inject_queue::~inject_queue()
+{
+	assert(_queue.empty());
+	assert(0 == _count);
+}
+//////////////////////////////////////////////////////////////////////////
+
+StealScheduler_::StealScheduler_(io_engine& ios)
+:_engine(ios), _ios(ios), _idleCount(0), _poller(NULL), _exited(false), _threads(0), _nodes(1) {}
+
+StealScheduler_::~StealScheduler_()
+{
+	for (worker* const ele : _workers)
+	{
+		delete ele;
+	}
+	for (worker* const ele : _retiredWorkers)
+	{
+		delete ele;
+	}
+	for (inject_queue* const ele : _nodeInject)
+	{
+		delete ele;
+	}
+}
+
+void StealScheduler_::open(size_t nodes)
+{
+	assert(_parkedWorkers.empty());
+	assert(0 == _threads);
+	//Ԥ߳߳ʱ·䣬߳̿ɼ
+	_workers.reserve(IO_ENGINE_MAX_THREADS);
+	while (_nodeInject.size() < nodes)
+	{
+		_nodeInject.push_back(new inject_queue);
+	}
+	_nodes = nodes;
+	_exited = false;
+}
+
+bool StealScheduler_::renew(size_t index, size_t node)
+{
+	assert(node < _nodes);
+	bool renewed = false;
+	if (index < _workers.size())
+	{
+		if (_workers[index]->_retire)
+		{
+			//ɶпаstrandָ򣬱֮Ͷݵɶеİstrandת߳
+			worker* const newWorker = new worker(this, index);
+			_workers[index]->_forward = newWorker;
+			_retiredWorkers.push_back(_workers[index]);
+			_workers[index] = newWorker;
+			renewed = true;
+		}
+	}
+	else
+	{
+		assert(index == _workers.size() && index < IO_ENGINE_MAX_THREADS);
+		_workers.push_back(new worker(this, index));
+	}
+	_workers[index]->_node = node;
+	if (_threads <= index)
+	{
+		_threads = index + 1;
+	}
+	return renewed;
+}
+
+void StealScheduler_::retire(size_t index, size_t forward)
+{
+	assert(index != forward);
+	worker* const target = get_worker(index);
+	target->_forward = get_worker(forward);
+	target->_retire = true;
+	notify_worker(target);
+}
+
+void StealScheduler_::close()
+{
+	assert(_inject._queue.empty());
+	assert(_realtimeInject._queue.empty());
+	assert(_backgroundInject._queue.empty());
+	assert(0 == _idleCount);
+	assert(_parkedWorkers.empty());
+	_poller = NULL;
+	_exited = false;
+	_threads = 0;
+	_nodes = 1;
+}
+
+StealScheduler_::worker* StealScheduler_::get_worker(size_t index)
+{
+	assert(index < _workers.size());
+	return _workers[index];
+}
+
+size_t StealScheduler_::class_depth(strand_class cls)
+{
+	switch (cls)
+	{
+	case strand_realtime:
+		return _realtimeInject._count;
+	case strand_background:
+		return _backgroundInject._count;
+	default:
+		{
+			size_t depth = _inject._count;
+			for (size_t i = 0; i < _nodes; i++)
+			{
+				depth += _nodeInject[i]->_count;
+			}
+			for (size_t i = 0; i < _threads; i++)
+			{
+				depth += _workers[i]->_readyCount;
+			}
+			return depth;
+		}
+	}
+}
+
+size_t StealScheduler_::run(size_t index, IdleSpin_& idleSpin)
+{
+	worker* const self = _workers[index];
+	io_engine::setTlsValue(STEAL_WORKER_INDEX, self);
+	size_t count = 0;
+	while (!_exited)
+	{
+		if (self->_retire)
+		{
+			retire(self);
+			break;
+		}
+		StrandEx_* strand = pick(self);
+		if (strand)
+		{
+			strand->run_task();
+			count++;
+			if (0 == ++self->_tick % STEAL_POLL_INTERVAL && !_poller)
+			{
+				count += poll_io();
+			}
+			continue;
+		}
+		if (!_poller)
+		{
+			const size_t n = poll_io();
+			if (n)
+			{
+				count += n;
+				continue;
+			}
+		}
+		if (idleSpin.enabled())
+		{
+			//ǰæȣæ̲߳УͶݷ軽ѣ
+			//ֻжʱŽpickio¼ֲpollһ
+			size_t n = 0;
+			size_t spins = 0;
+			if (idleSpin.spin([&]()->bool
+			{
+				if (has_work(self))
+				{
+					strand = pick(self);
+					if (strand)
+					{
+						return true;
+					}
+				}
+				return !_poller && 0 == ++spins % STEAL_SPIN_POLL_INTERVAL && 0 != (n = poll_io());
+			}))
+			{
+				count += n;
+				if (strand)
+				{
+					strand->run_task();
+					count++;
+				}
+				continue;
+			}
+		}
+		//ȵǼǿٸһУnotifyеĻѼԣⶪʧ
+		_idleCount++;
+		strand = pick(self);
+		if (!strand)
+		{
+			worker* noneWorker = NULL;
+			if (_poller.compare_exchange_strong(noneWorker, self))
+			{
+				//Ϊioȴ̣߳io_service
+				strand = pick(self);
+				if (!strand && !self->_retire)
+				{
+					const size_t n = _ios.run_one();
+					idleSpin.wakeup();
+					_poller = NULL;
+					_idleCount--;
+					if (!n)
+					{
+						//io_service֪ͨ߳˳
+						std::lock_guard<std::mutex> lg(_parkMutex);
+						_exited = true;
+						for (worker* const ele : _parkedWorkers)
+						{
+							ele->_parked = false;
+							ele->_wakeup = true;
+							ele->_parkVar.notify_one();
+						}
+						_parkedWorkers.clear();
+						break;
+					}
+					count += n;
+					//ioȴɫù߳̽
+					notify();
+					continue;
+				}
+				_poller = NULL;
+			}
+			else
+			{
+				strand = park(self);
+				idleSpin.wakeup();
+			}
+		}
+		_idleCount--;
+		if (strand)
+		{
+			strand->run_task();
+			count++;
+		}
+	}
+	io_engine::setTlsValue(STEAL_WORKER_INDEX, NULL);
+	return count;
+}
+
+size_t StealScheduler_::poll_io()
+{
+	//poll_oneƴתеĻ¼ڱ߳ڷִ
+	size_t n = 0;
+	while (n < STEAL_POLL_INTERVAL && _ios.poll_one())
+	{
+		n++;
+	}
+	return n;
+}
+
+void StealScheduler_::schedule(StrandEx_* strand)
+{
+	schedule_batch(&strand, 1);
+}
+
+void StealScheduler_::schedule_batch(StrandEx_* const* strands, size_t n)
+{
+	worker* const self = current_worker();
+	op_queue readyQueue;
+	size_t count = 0;
+	size_t classCount = 0;
+	for (size_t i = 0; i < n; i++)
+	{
+		StrandEx_* const strand = strands[i];
+		const size_t node = strand->_node;
+		if (strand->_pinWorker)
+		{
+			schedule_pinned(strand, strand->_pinWorker);
+		}
+		else if ((size_t)-1 != node && node < _nodes && (!self || self->_node != node))
+		{
+			//ָڵstrandֻڱڵ߳ϵ
+			push_inject(*_nodeInject[node], strand);
+			notify_node(node);
+		}
+		else if (strand_normal != strand->_class)
+		{
+			//ּstrandȫַּУpickȼȡ
+			push_inject(strand_realtime == strand->_class ? _realtimeInject : _backgroundInject, strand);
+			classCount++;
+		}
+		else
+		{
+			readyQueue.push_back(&strand->_scheduleNode);
+			count++;
+		}
+	}
+	if (count)
+	{
+		if (self)
+		{
+			self->_mutex.lock();
+			self->_readyQueue.push_back(readyQueue);
+			self->_readyCount += count;
+			self->_mutex.unlock();
+		}
+		else
+		{
+			_inject._mutex.lock();
+			_inject._queue.push_back(readyQueue);
+			_inject._count += count;
+			_inject._mutex.unlock();
+		}
+	}
+	if (count + classCount)
+	{
+		notify(count + classCount);
+	}
+}
+
+void StealScheduler_::push_inject(inject_queue& injectQueue, StrandEx_* strand)
+{
+	injectQueue._mutex.lock();
+	injectQueue._queue.push_back(&strand->_scheduleNode);
+	injectQueue._count++;
+	injectQueue._mutex.unlock();
+}
+
+void StealScheduler_::schedule_pinned(StrandEx_* strand, worker* pinWorker)
+{
+	if (current_worker() == pinWorker)
+	{
+		pinWorker->_pinnedQueue.push_back(&strand->_scheduleNode);
+	}
+	else
+	{
+		pinWorker->_pinnedInbox.push(&strand->_scheduleNode);
+		//retireȱȡԣ߳ʱͶݷת߳
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (pinWorker->_retired)
+		{
+			drain_retired(pinWorker);
+		}
+		else
+		{
+			notify_worker(pinWorker);
+		}
+	}
+}
+
+void StealScheduler_::retire(worker* self)
+{
+	{
+		std::lock_guard<std::mutex> lg(self->_mutex);
+		//߳Ͷݵİstrandֻڱ̷߳ʣǰһת
+		while (!self->_pinnedQueue.empty())
+		{
+			self->_readyQueue.push_back(self->_pinnedQueue.pop_front());
+			self->_readyCount++;
+		}
+		self->_retired = true;
+	}
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	drain_retired(self);
+}
+
+void StealScheduler_::drain_retired(worker* target)
+{
+	op_queue readyQueue;
+	size_t count = 0;
+	{
+		//ȡ֮Զ⣬֤mpscֻһ
+		std::lock_guard<std::mutex> lg(target->_mutex);
+		assert(target->_retired);
+		count = target->_readyCount;
+		target->_readyCount = 0;
+		readyQueue.push_back(target->_readyQueue);
+		mpsc_queue::face* node = target->_pinnedInbox.pop();
+		while (node)
+		{
+			readyQueue.push_back(static_cast<StrandEx_::schedule_node*>(node));
+			count++;
+			node = target->_pinnedInbox.pop();
+		}
+	}
+	//strandתֻ̣߳һִ߳УָڵstrandתڵעУתȫע
+	op_queue injectQueue;
+	size_t injectCount = 0;
+	worker* const forward = target->_forward;
+	while (!readyQueue.empty())
+	{
+		StrandEx_::schedule_node* const node = static_cast<StrandEx_::schedule_node*>(readyQueue.pop_front());
+		const size_t strandNode = node->_strand->_node;
+		if (node->_strand->_pinWorker)
+		{
+			assert(forward);
+			count--;
+			schedule_pinned(node->_strand, forward);
+		}
+		else if ((size_t)-1 != strandNode && strandNode < _nodes)
+		{
+			push_inject(*_nodeInject[strandNode], node->_strand);
+			notify_node(strandNode);
+		}
+		else
+		{
+			injectQueue.push_back(node);
+			injectCount++;
+		}
+	}
+	if (injectCount)
+	{
+		_inject._mutex.lock();
+		_inject._queue.push_back(injectQueue);
+		_inject._count += injectCount;
+		_inject._mutex.unlock();
+	}
+	//߳̿ioȴ̣߳ٻһ߳̽
+	notify(count ? count : 1);
+}
+
+bool StealScheduler_::has_work(worker* self)
+{
+	if (self->_readyCount || !self->_pinnedQueue.empty() || !self->_pinnedInbox.empty()
+		|| _inject._count || _nodeInject[self->_node]->_count || _realtimeInject._count || _backgroundInject._count)
+	{
+		return true;
+	}
+	const size_t n = _threads;
+	for (size_t i = 0; i < n; i++)
+	{
+		if (_workers[i]->_readyCount)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+StrandEx_* StealScheduler_::pick(worker* self)
+{
+	StrandEx_* strand = NULL;
+	//ʵʱstrandȵȣSTRAND_CLASS_QUOTAκóһθȼ
+	if (!_realtimeInject._count)
+	{
+		self->_realtimeRun = 0;
+	}
+	else if (self->_realtimeRun < STRAND_CLASS_QUOTA)
+	{
+		strand = pop_inject(_realtimeInject);
+		if (strand)
+		{
+			self->_realtimeRun++;
+			return strand;
+		}
+	}
+	else
+	{
+		self->_realtimeRun = 0;
+	}
+	//̨strandѹʱÿSTRAND_CLASS_QUOTAͨstrandһκ̨strand
+	if (_backgroundInject._count && self->_normalRun >= STRAND_CLASS_QUOTA)
+	{
+		self->_normalRun = 0;
+		strand = pop_inject(_backgroundInject);
+		if (strand)
+		{
+			return strand;
+		}
+	}
+	strand = pick_normal(self);
+	if (strand)
+	{
+		if (_backgroundInject._count)
+		{
+			self->_normalRun++;
+		}
+		return strand;
+	}
+	strand = pop_inject(_backgroundInject);
+	return strand ? strand : pop_inject(_realtimeInject);
+}
+
+StrandEx_* StealScheduler_::pick_normal(worker* self)
+{
+	StrandEx_* strand = NULL;
+	if (self->_tick & 1)
+	{
+		strand = pop_pinned(self);
+	}
+	if (!strand && 0 == self->_tick % STEAL_INJECT_INTERVAL)
+	{
+		strand = pop_inject(self);
+	}
+	if (!strand)
+	{
+		strand = pop_local(self);
+		if (!strand)
+		{
+			strand = pop_pinned(self);
+			if (!strand)
+			{
+				strand = pop_inject(self);
+				if (!strand)
+				{
+					strand = steal(self);
+				}
+			}
+		}
+	}
+	return strand;
+}
+
+StrandEx_* StealScheduler_::pop_local(worker* self)
+{
+	if (self->_readyCount)
+	{
+		std::lock_guard<std::mutex> lg(self->_mutex);
+		if (!self->_readyQueue.empty())
+		{
+			self->_readyCount--;
+			return static_cast<StrandEx_::schedule_node*>(self->_readyQueue.pop_front())->_strand;
+		}
+	}
+	return NULL;
+}
+
+StrandEx_* StealScheduler_::pop_pinned(worker* self)
+{
+	if (!self->_pinnedQueue.empty())
+	{
+		return static_cast<StrandEx_::schedule_node*>(self->_pinnedQueue.pop_front())->_strand;
+	}
+	mpsc_queue::face* const node = self->_pinnedInbox.pop();
+	if (node)
+	{
+		return static_cast<StrandEx_::schedule_node*>(node)->_strand;
+	}
+	return NULL;
+}
+
+StrandEx_* StealScheduler_::pop_inject(worker* self)
+{
+	StrandEx_* const strand = pop_inject(*_nodeInject[self->_node]);
+	return strand ? strand : pop_inject(_inject);
+}
+
+StrandEx_* StealScheduler_::pop_inject(inject_queue& injectQueue)
+{
+	if (injectQueue._count)
+	{
+		std::lock_guard<std::mutex> lg(injectQueue._mutex);
+		if (!injectQueue._queue.empty())
+		{
+			injectQueue._count--;
+			return static_cast<StrandEx_::schedule_node*>(injectQueue._queue.pop_front())->_strand;
+		}
+	}
+	return NULL;
+}
+
+StrandEx_* StealScheduler_::steal(worker* self)
+{
+	//ȴӱڵ߳ȡڵ㶼ʱٿڵ
+	StrandEx_* const strand = steal(self, false);
+	return strand || 1 == _nodes ? strand : steal(self, true);
+}
+
+StrandEx_* StealScheduler_::steal(worker* self, bool remote)
+{
+	const size_t n = _threads;
+	const size_t seed = ++self->_stealSeed;
+	for (size_t i = 0; i < n; i++)
+	{
+		worker* const other = _workers[(seed + i) % n];
+		if (other == self || !other->_readyCount || remote == (other->_node == self->_node))
+		{
+			continue;
+		}
+		//һȡԷһľstrandٷȡ
+		op_queue stealQueue;
+		size_t stealCount = 0;
+		{
+			std::lock_guard<std::mutex> lg(other->_mutex);
+			if (remote)
+			{
+				//ڵֻȡ޽ڵstrand󶨽ڵstrandԭ˳ڶԷ
+				const size_t maxCount = (other->_readyCount + 1) / 2;
+				op_queue keepQueue;
+				while (!other->_readyQueue.empty())
+				{
+					op_queue::face* const node = other->_readyQueue.pop_front();
+					if (stealCount < maxCount && (size_t)-1 == static_cast<StrandEx_::schedule_node*>(node)->_strand->_node)
+					{
+						stealQueue.push_back(node);
+						stealCount++;
+					}
+					else
+					{
+						keepQueue.push_back(node);
+					}
+				}
+				other->_readyQueue.swap(keepQueue);
+			}
+			else
+			{
+				stealCount = (other->_readyCount + 1) / 2;
+				for (size_t j = 0; j < stealCount; j++)
+				{
+					stealQueue.push_back(other->_readyQueue.pop_front());
+				}
+			}
+			other->_readyCount -= stealCount;
+		}
+		if (stealCount)
+		{
+			StrandEx_* const strand = static_cast<StrandEx_::schedule_node*>(stealQueue.pop_front())->_strand;
+			if (stealCount > 1)
+			{
+				std::lock_guard<std::mutex> lg(self->_mutex);
+				self->_readyQueue.push_back(stealQueue);
+				self->_readyCount += stealCount - 1;
+			}
+			return strand;
+		}
+	}
+	return NULL;
+}
+
+StrandEx_* StealScheduler_::park(worker* self)
+{
+	{
+		std::lock_guard<std::mutex> lg(_parkMutex);
+		if (_exited || self->_retire)
+		{
+			return NULL;
+		}
+		self->_parked = true;
+		self->_wakeup = false;
+		_parkedWorkers.push_back(self);
+	}
+	//ǼǹٸһУnotify/notify_worker
+	StrandEx_* const strand = pick(self);
+	std::unique_lock<std::mutex> ul(_parkMutex);
+	if (self->_parked && !strand)
+	{
+		while (!self->_wakeup && !_exited && !self->_retire)
+		{
+			self->_parkVar.wait(ul);
+		}
+	}
+	if (self->_parked)
+	{
+		self->_parked = false;
+		_parkedWorkers.erase(std::find(_parkedWorkers.begin(), _parkedWorkers.end(), self));
+	}
+	return strand;
+}
+
+void StealScheduler_::notify(size_t count)
+{
+	if (_idleCount)
+	{
+		{
+			std::lock_guard<std::mutex> lg(_parkMutex);
+			while (count && !_parkedWorkers.empty())
+			{
+				worker* const target = _parkedWorkers.back();
+				_parkedWorkers.pop_back();
+				target->_parked = false;
+				target->_wakeup = true;
+				target->_parkVar.notify_one();
+				count--;
+			}
+			if (!count)
+			{
+				return;
+			}
+		}
+		if (_poller)
+		{
+			post_wakeup(NULL);
+		}
+	}
+}
+
+void StealScheduler_::notify_node(size_t node)
+{
+	if (_idleCount)
+	{
+		{
+			std::lock_guard<std::mutex> lg(_parkMutex);
+			for (auto it = _parkedWorkers.rbegin(); it != _parkedWorkers.rend(); ++it)
+			{
+				worker* const target = *it;
+				if (target->_node == node)
+				{
+					_parkedWorkers.erase(std::next(it).base());
+					target->_parked = false;
+					target->_wakeup = true;
+					target->_parkVar.notify_one();
+					return;
+				}
+			}
+		}
+		worker* const poller = _poller;
+		if (poller && poller->_node == node)
+		{
+			post_wakeup(poller);
+		}
+	}
+}
+
+void StealScheduler_::notify_worker(worker* target)
+{
+	{
+		std::lock_guard<std::mutex> lg(_parkMutex);
+		if (target->_parked)
+		{
+			target->_parked = false;
+			target->_wakeup = true;
+			_parkedWorkers.erase(std::find(_parkedWorkers.begin(), _parkedWorkers.end(), target));
+			target->_parkVar.notify_one();
+			return;
+		}
+	}
+	if (target == _poller)
+	{
+		post_wakeup(target);
+	}
+}
+
+void StealScheduler_::post_wakeup(worker* target)
+{
+	_ios.post([this, target]
+	{
+		//¼̵ܱ߳pollȡߣʱתĿ߳
+		if (target && target != current_worker())
+		{
+			notify_worker(target);
+		}
+	});
+}
+
+StealScheduler_::worker* StealScheduler_::current_worker()
+{
+	void** const tlsBuff = io_engine::getTlsValueBuff();
+	if (tlsBuff && tlsBuff[STEAL_WORKER_INDEX])
+	{
+		worker* const self = (worker*)tlsBuff[STEAL_WORKER_INDEX];
+		if (this == self->_owner)
+		{
+			return self;
+		}
+	}
+	return NULL;
+}
\ No newline at end of file
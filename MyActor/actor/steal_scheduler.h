@@ -0,0 +1,188 @@
+#ifndef __STEAL_SCHEDULER_H
+#define __STEAL_SCHEDULER_H
+
+#include <boost/asio/io_service.hpp>
+#include <condition_variable>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "msg_queue.h"
+#include "scattered.h"
+#include "idle_spin.h"
+
+//ÿٴstrandȣ崦һio¼
+#ifndef STEAL_POLL_INTERVAL
+#define STEAL_POLL_INTERVAL 64
+#endif
+
+//ÿٴstrandȣȼһȫעУֹ
+#ifndef STEAL_INJECT_INTERVAL
+#define STEAL_INJECT_INTERVAL 61
+#endif
+
+//æʱÿpollһio¼(pollҪio_service)
+#ifndef STEAL_SPIN_POLL_INTERVAL
+#define STEAL_SPIN_POLL_INTERVAL 8
+#endif
+
+//ȼstrandȶٴκȼлѹóһΣֹ
+#ifndef STRAND_CLASS_QUOTA
+#define STRAND_CLASS_QUOTA 32
+#endif
+
+/*!
+@brief strandȼȼڵȼȣȼִ
+*/
+enum strand_class
+{
+	strand_realtime,//ʵʱӳе
+	strand_normal,//ͨ
+	strand_background,//̨
+	strand_class_num
+};
+
+class io_engine;
+class StrandEx_;
+
+/*!
+@brief ȡÿ̳߳һstrandУضΪʱ߳ȡ
+ֻ߳һio_serviceϵȴio¼ڸԵϣɶ
+*/
+class StealScheduler_
+{
+	friend io_engine;
+	friend StrandEx_;
+
+	struct worker
+	{
+		worker(StealScheduler_* owner, size_t index);
+		~worker();
+
+		StealScheduler_* const _owner;
+		const size_t _index;
+		size_t _node;
+		std::mutex _mutex;
+		op_queue _readyQueue;
+		std::atomic<size_t> _readyCount;
+		op_queue _pinnedQueue;//߳Ͷݵİstrandֻڱ̷߳
+		mpsc_queue _pinnedInbox;//߳Ͷݵİstrand
+		std::condition_variable _parkVar;
+		bool _parked;
+		bool _wakeup;
+		size_t _stealSeed;
+		size_t _tick;
+		std::atomic<bool> _retire;//ۣ߳̿к˳
+		std::atomic<bool> _retired;//ۣѱУͶݷֱתע(strandת_forward)
+		std::atomic<worker*> _forward;//ۺձ̰߳strand߳
+		size_t _realtimeRun;//ʵʱstrandĴ
+		size_t _normalRun;//̨strandѹʱͨstrandĴ
+	};
+
+	//עУǵ߳ͶݵstrandȫֶУָڵstrandڽڵ
+	struct inject_queue
+	{
+		inject_queue();
+		~inject_queue();
+
+		std::mutex _mutex;
+		op_queue _queue;
+		std::atomic<size_t> _count;
+	};
+private:
+	StealScheduler_(io_engine& ios);
+	~StealScheduler_();
+private:
+	/*!
+	@brief ǰλ״̬̹߳renew
+	@param nodes ڵ
+	*/
+	void open(size_t nodes);
+
+	/*!
+	@brief õindex̵߳ĹУ۵Ķл¶(ɶԱstrandã)
+	@return true 滻۵ĶУԭstrandɶת̣߳½İstrandӦֱӰ¶
+	*/
+	bool renew(size_t index, size_t node);
+
+	/*!
+	@brief indexۣ߳߳̿кѱضתעУstrandתforwarḍ߳˳
+	ԭústrandת߳
+	*/
+	void retire(size_t index, size_t forward);
+
+	/*!
+	@brief ֹͣλ״̬
+	*/
+	void close();
+
+	/*!
+	@brief ߳ѭرִ߳е
+	@param idleSpin ʱȰвæȣʱٹ
+	*/
+	size_t run(size_t index, IdleSpin_& idleSpin);
+
+	/*!
+	@brief strand״̬Ͷݵǰ̱߳ض(ǵ߳Ͷݵȫע)
+	ָ˽ڵstrandڵ߳Ͷʱڽڵע
+	*/
+	void schedule(StrandEx_* strand);
+
+	/*!
+	@brief һstrandͬʱ״̬ϲӣÿ߳໽һ
+	*/
+	void schedule_batch(StrandEx_* const* strands, size_t n);
+
+	/*!
+	@brief ̵߳strand״̬߳Ͷֱӣ߳̾Ͷ
+	*/
+	void schedule_pinned(StrandEx_* strand, worker* pinWorker);
+
+	/*!
+	@brief ȡindex̵߳Ĺ
+	*/
+	worker* get_worker(size_t index);
+
+	/*!
+	@brief ĳȼȴȵstrand
+	*/
+	size_t class_depth(strand_class cls);
+private:
+	bool has_work(worker* self);
+	StrandEx_* pick(worker* self);
+	StrandEx_* pick_normal(worker* self);
+	StrandEx_* pop_local(worker* self);
+	StrandEx_* pop_pinned(worker* self);
+	StrandEx_* pop_inject(worker* self);
+	StrandEx_* pop_inject(inject_queue& injectQueue);
+	StrandEx_* steal(worker* self);
+	StrandEx_* steal(worker* self, bool remote);
+	StrandEx_* park(worker* self);
+	void retire(worker* self);
+	void drain_retired(worker* target);
+	size_t poll_io();
+	void push_inject(inject_queue& injectQueue, StrandEx_* strand);
+	void notify(size_t count = 1);
+	void notify_node(size_t node);
+	void notify_worker(worker* target);
+	void post_wakeup(worker* target);
+	worker* current_worker();
+private:
+	io_engine& _engine;
+	boost::asio::io_service& _ios;
+	std::vector<worker*> _workers;
+	std::vector<worker*> _retiredWorkers;
+	std::vector<inject_queue*> _nodeInject;
+	inject_queue _inject;
+	inject_queue _realtimeInject;
+	inject_queue _backgroundInject;
+	std::atomic<int> _idleCount;
+	std::atomic<worker*> _poller;
+	std::mutex _parkMutex;
+	std::vector<worker*> _parkedWorkers;
+	std::atomic<bool> _exited;
+	std::atomic<size_t> _threads;
+	size_t _nodes;
+	NONE_COPY(StealScheduler_);
+};
+
+#endif
\ No newline at end of file
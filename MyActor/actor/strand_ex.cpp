@@ -1,74 +1,93 @@
 #include "strand_ex.h"
 #include "io_engine.h"
+#include "steal_scheduler.h"
+#include "check_actor_stack.h"
 
-namespace boost
+StrandClassQueue_::StrandClassQueue_()
 {
-	namespace asio
+	for (int i = 0; i < strand_class_num; i++)
 	{
-		namespace detail
-		{
-			struct get_impl_ready_empty_strand_ex
-			{
-				bool _empty;
-			};
-
-			struct get_impl_waiting_empty_strand_ex
-			{
-				bool _empty;
-			};
-
-			struct get_impl_running_strand_ex
-			{
-				bool _running;
-			};
-
-			struct get_impl_safe_running_strand_ex
-			{
-				bool _running;
-			};
+		_depth[i] = 0;
+		_quotaRun[i] = 0;
+	}
+}
 
-			template <>
-			void boost::asio::detail::strand_service::dispatch(boost::asio::detail::strand_service::implementation_type& impl, get_impl_ready_empty_strand_ex& fh)
-			{
-				fh._empty = impl->ready_queue_.empty();
-			}
+StrandClassQueue_::~StrandClassQueue_()
+{
+	for (int i = 0; i < strand_class_num; i++)
+	{
+		assert(_queue[i].empty());
+		assert(0 == _depth[i]);
+	}
+}
 
-			template <>
-			void boost::asio::detail::strand_service::dispatch(boost::asio::detail::strand_service::implementation_type& impl, get_impl_waiting_empty_strand_ex& fh)
-			{
-				fh._empty = impl->waiting_queue_.empty();
-			}
+void StrandClassQueue_::push(StrandEx_* strand)
+{
+	std::lock_guard<std::mutex> lg(_mutex);
+	_queue[strand->_class].push_back(&strand->_scheduleNode);
+	_depth[strand->_class]++;
+}
 
-			template <>
-			void boost::asio::detail::strand_service::dispatch(boost::asio::detail::strand_service::implementation_type& impl, get_impl_running_strand_ex& fh)
+StrandEx_* StrandClassQueue_::pop()
+{
+	std::lock_guard<std::mutex> lg(_mutex);
+	int cls = -1;
+	for (int i = 0; i < strand_class_num; i++)
+	{
+		if (!_queue[i].empty())
+		{
+			if (-1 != cls)
 			{
-				fh._running = impl->locked_;
+				//ȼóһθȼ
+				_quotaRun[cls] = 0;
+				cls = i;
+				break;
 			}
-
-			template <>
-			void boost::asio::detail::strand_service::dispatch(boost::asio::detail::strand_service::implementation_type& impl, get_impl_safe_running_strand_ex& fh)
+			cls = i;
+			if (_quotaRun[i] < STRAND_CLASS_QUOTA)
 			{
-				impl->mutex_.lock();
-				fh._running = impl->locked_;
-				impl->mutex_.unlock();
+				break;
 			}
 		}
 	}
+	//ÿƶӦһӣʱвΪ
+	assert(-1 != cls);
+	_depth[cls]--;
+	StrandEx_* const strand = static_cast<StrandEx_::schedule_node*>(_queue[cls].pop_front())->_strand;
+	_quotaRun[cls] = _queue[cls].empty() ? 0 : _quotaRun[cls] + 1;
+	return strand;
+}
+
+size_t StrandClassQueue_::depth(strand_class cls) const
+{
+	return _depth[cls];
 }
 //////////////////////////////////////////////////////////////////////////
 
-StrandEx_::StrandEx_(io_engine& ios)
-: _service(boost::asio::use_service<boost::asio::detail::strand_service>(ios)),
-_impl(new boost::asio::detail::strand_service::strand_impl()) {}
+StrandEx_::StrandEx_(io_engine& engine, boost::asio::io_service& ios)
+: _engine(engine), _ios(ios), _steal(engine._stealScheduler), _pinWorker(NULL), _node(-1), _class(strand_normal), _state(state_idle)
+#ifdef ENABLE_STRAND_STATS
+, _stats(NULL)
+#endif
+{
+	_scheduleNode._strand = this;
+}
 
 StrandEx_::~StrandEx_()
 {
-	delete _impl;
+	assert(state_idle == _state);
+	assert(_readyQueue.empty());
+	assert(_waitQueue.empty());
+	assert(_inbox.empty());
+#ifdef ENABLE_STRAND_STATS
+	delete _stats.load();
+#endif
 }
 
 bool StrandEx_::running_in_this_thread() const
 {
-	return boost::asio::detail::call_stack<boost::asio::detail::strand_service::strand_impl>::contains(_impl) != 0;
+	void** const tlsBuff = io_engine::getTlsValueBuff();
+	return tlsBuff && this == tlsBuff[STRAND_EX_RUN_INDEX];
 }
 
 bool StrandEx_::empty() const
@@ -78,40 +97,282 @@ bool StrandEx_::empty() const
 
 bool StrandEx_::ready_empty() const
 {
-	boost::asio::detail::get_impl_ready_empty_strand_ex t;
-	_service.dispatch((boost::asio::detail::strand_service::implementation_type&)_impl, t);
-	return t._empty;
+	return ((op_queue&)_readyQueue).empty();
 }
 
 bool StrandEx_::waiting_empty() const
 {
-	boost::asio::detail::get_impl_waiting_empty_strand_ex t;
-	_service.dispatch((boost::asio::detail::strand_service::implementation_type&)_impl, t);
-	return t._empty;
+	return ((op_queue&)_waitQueue).empty() && ((mpsc_queue&)_inbox).empty();
 }
 
 bool StrandEx_::running() const
 {
 	assert(running_in_this_thread());
-	boost::asio::detail::get_impl_running_strand_ex t;
-	_service.dispatch((boost::asio::detail::strand_service::implementation_type&)_impl, t);
-	return t._running;
+	return state_idle != _state;
 }
 
 bool StrandEx_::safe_running() const
 {
 	assert(!running_in_this_thread());
-	boost::asio::detail::get_impl_safe_running_strand_ex t;
-	_service.dispatch((boost::asio::detail::strand_service::implementation_type&)_impl, t);
-	return t._running;
+	return state_idle != _state;
 }
 
 bool StrandEx_::only_self() const
 {
 	assert(running_in_this_thread());
-#ifdef ASIO_CALL_STACK_DEPTH
-	return 1 == boost::asio::detail::call_stack<boost::asio::detail::strand_service::strand_impl>::stack_depth();
-#else
+	//dispatchֻڱstrandֱִУstrandִйǶִ
+	return true;
+}
+
+bool StrandEx_::is_pinned() const
+{
+	return NULL != _pinWorker;
+}
+
+bool StrandEx_::pin(size_t threadIndex)
+{
+	assert(!_pinWorker && state_idle == _state && empty());
+	if (_steal)
+	{
+		_pinWorker = _steal->get_worker(threadIndex);
+		return true;
+	}
+	return false;
+}
+
+bool StrandEx_::bind_node(size_t node)
+{
+	assert(!_pinWorker && state_idle == _state && empty());
+	if (_steal)
+	{
+		_node = node;
+		return true;
+	}
+	return false;
+}
+
+void StrandEx_::set_class(strand_class cls)
+{
+	assert(!_pinWorker && state_idle == _state && empty());
+	assert(cls < strand_class_num);
+	_class = cls;
+}
+
+bool StrandEx_::local_post() const
+{
+	//̵߳strandֻڰִ߳У߳ͶʱʹstrandҲֱӷʱض
+	return _pinWorker ? _steal->current_worker() == _pinWorker : running_in_this_thread();
+}
+
+void StrandEx_::append_task(wrap_handler_face* h, bool localPost)
+{
+	if (localPost)
+	{
+		//strand߳Ͷݣֱͬ
+		_waitQueue.push_back(h);
+		if (state_idle != _state || state_idle != _state.exchange(state_notified))
+		{
+			return;
+		}
+	}
+	else
+	{
+		_inbox.push(h);
+		if (state_idle != _state.exchange(state_notified))
+		{
+			return;
+		}
+	}
+	_engine.holdWork();
+	schedule();
+}
+
+bool StrandEx_::append_tasks(op_queue& tasks)
+{
+	assert(!tasks.empty());
+	if (local_post())
+	{
+		_waitQueue.push_back(tasks);
+		if (state_idle != _state || state_idle != _state.exchange(state_notified))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		//Ӻúֻһԭӽ
+		wrap_handler_face* const first = static_cast<wrap_handler_face*>(tasks.pop_front());
+		wrap_handler_face* last = first;
+		while (!tasks.empty())
+		{
+			wrap_handler_face* const h = static_cast<wrap_handler_face*>(tasks.pop_front());
+			mpsc_queue::link(last, h);
+			last = h;
+		}
+		_inbox.push(first, last);
+		if (state_idle != _state.exchange(state_notified))
+		{
+			return false;
+		}
+	}
+	_engine.holdWork();
 	return true;
+}
+
+void StrandEx_::schedule()
+{
+	if (_pinWorker)
+	{
+		_steal->schedule_pinned(this, _pinWorker);
+	}
+	else if (_steal)
+	{
+		_steal->schedule(this);
+	}
+	else if (strand_normal != _class)
+	{
+		//ͨȼstrandּгӣio_serviceֻͶƣͨstrandӰ죬ֱͶ
+		StrandClassQueue_* const classQueue = _engine._classQueue;
+		classQueue->push(this);
+		_ios.post([classQueue]
+		{
+			classQueue->pop()->run_task();
+		});
+	}
+	else
+	{
+		_ios.post([this]
+		{
+			run_task();
+		});
+	}
+}
+
+void StrandEx_::schedule_batch(std::vector<StrandEx_*>& strands)
+{
+	//ͬһstrandϲ
+	std::sort(strands.begin(), strands.end(), [](StrandEx_* a, StrandEx_* b)
+	{
+		return a->_steal < b->_steal;
+	});
+	for (size_t i = 0; i < strands.size();)
+	{
+		StealScheduler_* const steal = strands[i]->_steal;
+		size_t j = i + 1;
+		while (j < strands.size() && steal == strands[j]->_steal)
+		{
+			j++;
+		}
+		if (steal)
+		{
+			steal->schedule_batch(&strands[i], j - i);
+		}
+		else
+		{
+			for (size_t k = i; k < j; k++)
+			{
+				strands[k]->schedule();
+			}
+		}
+		i = j;
+	}
+}
+
+void StrandEx_::run_task()
+{
+	assert(state_idle != _state);
+	//лִ״̬ȡУ֮Ͷݻ״̬Ϊstate_notified
+	_state = state_running;
+	mpsc_queue::face* node = _inbox.pop();
+	while (node)
+	{
+		_readyQueue.push_back(static_cast<wrap_handler_face*>(node));
+		node = _inbox.pop();
+	}
+	_readyQueue.push_back(_waitQueue);
+	void* const prevStrand = io_engine::swapTlsValue(STRAND_EX_RUN_INDEX, this);
+#ifdef ENABLE_LOOP_TICK
+	//ڵĶʱοʼʱΪ׼ʡȥÿζʱ
+	long long loopTick = get_tick_us();
+	void* const prevLoopTick = io_engine::swapTlsValue(LOOP_TICK_INDEX, &loopTick);
+#endif
+#ifdef ENABLE_STRAND_STATS
+	StrandStatsSink_ statsSink = stats_sink();
+#ifndef ENABLE_NEXT_TICK
+	size_t roundCount = 0;
+#endif
+#endif
+	while (!_readyQueue.empty())
+	{
+		wrap_handler_face* h = static_cast<wrap_handler_face*>(_readyQueue.pop_front());
+#ifdef ENABLE_STRAND_STATS
+		const long long beginTick = get_tick_ns();
+		statsSink.queue_wait(beginTick - h->_postTick);
+		h->invoke();
+		statsSink.run_time(get_tick_ns() - beginTick);
+#ifndef ENABLE_NEXT_TICK
+		roundCount++;
+#endif
+#else
+		h->invoke();
 #endif
-}
\ No newline at end of file
+		free_handler(h);
+	}
+#ifdef ENABLE_STRAND_STATS
+#ifndef ENABLE_NEXT_TICK
+	statsSink.round_ticks(roundCount);
+#endif
+#endif
+#ifdef ENABLE_LOOP_TICK
+	io_engine::setTlsValue(LOOP_TICK_INDEX, prevLoopTick);
+#endif
+	io_engine::setTlsValue(STRAND_EX_RUN_INDEX, prevStrand);
+	if (_waitQueue.empty())
+	{
+		io_engine& engine = _engine;
+		int state = state_running;
+		//״̬лؿкٷʱڼͶлʧܣ
+		if (_state.compare_exchange_strong(state, state_idle))
+		{
+			engine.releaseWork();
+			return;
+		}
+	}
+	schedule();
+}
+
+void StrandEx_::free_handler(wrap_handler_face* h)
+{
+	if (h->_localMem)
+	{
+		_localMem.deallocate(h);
+	}
+	else
+	{
+		free(h);
+	}
+}
+
+#ifdef ENABLE_STRAND_STATS
+StrandStatsSink_ StrandEx_::stats_sink() const
+{
+	void** const tlsBuff = io_engine::getTlsValueBuff();
+	StrandStatsSink_ res = { tlsBuff ? (StrandStats_*)tlsBuff[STRAND_STATS_INDEX] : NULL, _stats.load(std::memory_order_acquire) };
+	return res;
+}
+
+strand_stats StrandEx_::stats(bool reset)
+{
+	StrandStats_* stats = _stats.load(std::memory_order_acquire);
+	if (!stats)
+	{
+		StrandStats_* const newStats = new StrandStats_();
+		if (_stats.compare_exchange_strong(stats, newStats))
+		{
+			return strand_stats();
+		}
+		delete newStats;
+	}
+	return stats->snapshot(reset);
+}
+#endif
\ No newline at end of file
@@ -2,20 +2,109 @@
 #define __STRAND_EX_H
 
 #include <algorithm>
-#include <boost/asio/detail/strand_service.hpp>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <boost/asio/io_service.hpp>
 #include "try_move.h"
+#include "msg_queue.h"
+#include "steal_scheduler.h"
+#include "strand_stats.h"
 
 class io_engine;
 class boost_strand;
+class StealScheduler_;
+class post_batch_scope;
+class StrandEx_;
 
 /*!
-@brief ޸ı׼boost strandimpl_Ϊռ
+@brief asio_strandģʽµķּУstrandʱӲio_serviceͶһƣ
+ִʱȡǰȼߵstrandֻзͨȼstrand˶УͨstrandʼֱͶݵio_service
+*/
+class StrandClassQueue_
+{
+	friend io_engine;
+	friend StrandEx_;
+private:
+	StrandClassQueue_();
+	~StrandClassQueue_();
+private:
+	void push(StrandEx_* strand);
+	StrandEx_* pop();
+	size_t depth(strand_class cls) const;
+private:
+	std::mutex _mutex;
+	op_queue _queue[strand_class_num];
+	std::atomic<size_t> _depth[strand_class_num];
+	size_t _quotaRun[strand_class_num];
+	NONE_COPY(StrandClassQueue_);
+};
+
+/*!
+@brief strandںˣͶݾ߶н룬һԭӵ״̬֤ͬһʱֻһִ߳
 */
 class StrandEx_
 {
 	friend boost_strand;
+	friend StealScheduler_;
+	friend StrandClassQueue_;
+	friend post_batch_scope;
+
+	struct wrap_handler_face : public op_queue::face, public mpsc_queue::face
+	{
+		virtual void invoke() = 0;
+		bool _localMem;
+#ifdef ENABLE_STRAND_STATS
+		long long _postTick;
+#endif
+	};
+
+	template <typename Handler>
+	struct wrap_handler : public wrap_handler_face
+	{
+		typedef RM_CREF(Handler) handler_type;
+
+		wrap_handler(Handler& handler)
+			:_handler(std::forward<Handler>(handler)) {}
+
+		void invoke()
+		{
+			CHECK_EXCEPTION(_handler);
+			this->~wrap_handler();
+		}
+
+		handler_type _handler;
+	};
+
+	template <typename Handler>
+	wrap_handler_face* make_wrap_handler(Handler&& handler, bool localPost)
+	{
+		typedef wrap_handler<Handler> handler_type;
+		//strand߳Ͷʹ˽ڴأ߳ͶֱӴӶϷ䣬֮侺
+		void* const space = localPost ? _localMem.allocate(sizeof(handler_type)) : malloc(sizeof(handler_type));
+		wrap_handler_face* const h = new(space)handler_type(handler);
+		h->_localMem = localPost;
+#ifdef ENABLE_STRAND_STATS
+		h->_postTick = get_tick_ns();
+#endif
+		return h;
+	}
+
+	//״̬
+	enum schedule_state
+	{
+		state_idle,//
+		state_running,//ѵȻִ
+		state_notified//ִڼ߳Ͷ
+	};
+
+	//ȶнڵ
+	struct schedule_node : public op_queue::face, public mpsc_queue::face
+	{
+		StrandEx_* _strand;
+	};
 private:
-	StrandEx_(io_engine& ios);
+	StrandEx_(io_engine& engine, boost::asio::io_service& ios);
 	~StrandEx_();
 
 	bool running_in_this_thread() const;
@@ -25,35 +114,100 @@ private:
 	bool running() const;
 	bool safe_running() const;
 	bool only_self() const;
+	bool is_pinned() const;
+
+	/*!
+	@brief 󶨵threadIndexִ߳(work_stealģʽЧ)ֻڴͶǰ
+	*/
+	bool pin(size_t threadIndex);
+
+	/*!
+	@brief ޶ֻnodeڵĵִ߳(work_stealģʽЧ)ֻڴͶǰ
+	*/
+	bool bind_node(size_t node);
+
+	/*!
+	@brief õȼֻڴͶǰ
+	*/
+	void set_class(strand_class cls);
 
 	template <typename Handler>
 	void post(Handler& handler)
 	{
-		boost::asio::detail::async_result_init<Handler&, void()> init(handler);
-		_service.post(_impl, init.handler);
+		const bool localPost = local_post();
+		append_task(make_wrap_handler(handler, localPost), localPost);
 	}
 
 	template <typename Handler>
 	void dispatch(Handler& handler)
 	{
-		boost::asio::detail::async_result_init<Handler&, void()> init(handler);
-		_service.dispatch(_impl, init.handler);
+		if (running_in_this_thread())
+		{
+			CHECK_EXCEPTION(handler);
+		}
+		else
+		{
+			const bool localPost = local_post();
+			append_task(make_wrap_handler(handler, localPost), localPost);
+		}
 	}
 
 	template <typename Handler>
 	void post(Handler&& handler)
 	{
-		_service.post(_impl, handler);
+		const bool localPost = local_post();
+		append_task(make_wrap_handler(std::forward<Handler>(handler), localPost), localPost);
 	}
 
 	template <typename Handler>
 	void dispatch(Handler&& handler)
 	{
-		_service.dispatch(_impl, handler);
+		if (running_in_this_thread())
+		{
+			CHECK_EXCEPTION(handler);
+		}
+		else
+		{
+			const bool localPost = local_post();
+			append_task(make_wrap_handler(std::forward<Handler>(handler), localPost), localPost);
+		}
 	}
 private:
-	boost::asio::detail::strand_service& _service;
-	boost::asio::detail::strand_service::implementation_type _impl;
+	bool local_post() const;
+	void append_task(wrap_handler_face* h, bool localPost);
+
+	/*!
+	@brief һ׷һ񣬷trueʾstrandӿתΪȣɵߵschedule
+	*/
+	bool append_tasks(op_queue& tasks);
+	void schedule();
+	static void schedule_batch(std::vector<StrandEx_*>& strands);
+	void run_task();
+	void free_handler(wrap_handler_face* h);
+#ifdef ENABLE_STRAND_STATS
+	StrandStatsSink_ stats_sink() const;
+
+	/*!
+	@brief ״εʱŷ䱾strandͳƣ֮ǰĵ̵ֻ߳Ļ
+	*/
+	strand_stats stats(bool reset);
+#endif
+private:
+	io_engine& _engine;
+	boost::asio::io_service& _ios;
+	StealScheduler_* const _steal;
+	reusable_mem _localMem;
+	op_queue _waitQueue;//strand߳Ͷݵ
+	op_queue _readyQueue;//ִе
+	mpsc_queue _inbox;//߳Ͷݵ
+	schedule_node _scheduleNode;
+	StealScheduler_::worker* _pinWorker;
+	size_t _node;//-1ʾ޽ڵ
+	strand_class _class;
+	std::atomic<int> _state;
+#ifdef ENABLE_STRAND_STATS
+	std::atomic<StrandStats_*> _stats;
+#endif
 };
 
 #endif
\ No newline at end of file
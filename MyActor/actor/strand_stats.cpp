@@ -0,0 +1,205 @@
+#include "strand_stats.h"
+
+#ifdef ENABLE_STRAND_STATS
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline int high_bit(unsigned long long value)
+{
+#ifdef _MSC_VER
+	unsigned long i;
+	if (_BitScanReverse(&i, (unsigned long)(value >> 32)))
+	{
+		return (int)i + 32;
+	}
+	_BitScanReverse(&i, (unsigned long)value);
+	return (int)i;
+#else
+	return 63 - __builtin_clzll(value);
+#endif
+}
+
+histogram_snapshot::histogram_snapshot()
+:count(0), sum(0), max(0), buckets(STATS_BUCKET_NUM, 0) {}
+
+long long histogram_snapshot::percentile(double p) const
+{
+	if (!count)
+	{
+		return 0;
+	}
+	const long long target = (long long)((double)count * p / 100.0 + 0.5);
+	long long n = 0;
+	for (size_t i = 0; i < buckets.size(); i++)
+	{
+		n += buckets[i];
+		if (n >= target && n)
+		{
+			const long long upper = StatsHistogram_::bucket_upper(i);
+			return upper < max ? upper : max;
+		}
+	}
+	return max;
+}
+
+double histogram_snapshot::mean() const
+{
+	return count ? (double)sum / (double)count : 0;
+}
+
+void histogram_snapshot::merge(const histogram_snapshot& other)
+{
+	count += other.count;
+	sum += other.sum;
+	max = max > other.max ? max : other.max;
+	for (size_t i = 0; i < buckets.size(); i++)
+	{
+		buckets[i] += other.buckets[i];
+	}
+}
+//////////////////////////////////////////////////////////////////////////
+
+StatsHistogram_::StatsHistogram_()
+:_count(0), _sum(0), _max(0)
+{
+	for (size_t i = 0; i < STATS_BUCKET_NUM; i++)
+	{
+		_buckets[i] = 0;
+	}
+}
+
+void StatsHistogram_::record(long long value)
+{
+	if (value < 0)
+	{
+		value = 0;
+	}
+	//ֻһ¼дؼɣҪǰ׺ԭָ
+	std::atomic<long long>& bucket = _buckets[bucket_index(value)];
+	bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	_count.store(_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	_sum.store(_sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	if (value > _max.load(std::memory_order_relaxed))
+	{
+		_max.store(value, std::memory_order_relaxed);
+	}
+}
+
+void StatsHistogram_::snapshot(histogram_snapshot& res, histogram_snapshot& base, bool reset)
+{
+	//¼ղʱֶοڼ¼ļֵӰͳ
+	for (size_t i = 0; i < STATS_BUCKET_NUM; i++)
+	{
+		const long long n = _buckets[i].load(std::memory_order_relaxed);
+		res.buckets[i] = n - base.buckets[i];
+		if (reset)
+		{
+			base.buckets[i] = n;
+		}
+	}
+	const long long count = _count.load(std::memory_order_relaxed);
+	const long long sum = _sum.load(std::memory_order_relaxed);
+	res.count = count - base.count;
+	res.sum = sum - base.sum;
+	res.max = reset ? _max.exchange(0, std::memory_order_relaxed) : _max.load(std::memory_order_relaxed);
+	if (reset)
+	{
+		base.count = count;
+		base.sum = sum;
+	}
+}
+
+size_t StatsHistogram_::bucket_index(long long value)
+{
+	const long long subCount = 1LL << STATS_SUB_BITS;
+	if (value < subCount)
+	{
+		return (size_t)value;
+	}
+	//λ֮STATS_SUB_BITS-1λΪ
+	const int shift = high_bit((unsigned long long)value) - (STATS_SUB_BITS - 1);
+	const long long halfCount = subCount / 2;
+	return (size_t)(subCount + (shift - 1) * halfCount + ((value >> shift) - halfCount));
+}
+
+long long StatsHistogram_::bucket_upper(size_t index)
+{
+	const size_t subCount = (size_t)1 << STATS_SUB_BITS;
+	if (index < subCount)
+	{
+		return (long long)index;
+	}
+	const size_t halfCount = subCount / 2;
+	const int shift = (int)((index - subCount) / halfCount) + 1;
+	const long long sub = (long long)((index - subCount) % halfCount + halfCount);
+	return ((sub + 1) << shift) - 1;
+}
+//////////////////////////////////////////////////////////////////////////
+
+StrandStats_::StrandStats_() {}
+
+void StrandStats_::queue_wait(long long ns)
+{
+	_queueWait.record(ns);
+}
+
+void StrandStats_::run_time(long long ns)
+{
+	_runTime.record(ns);
+}
+
+void StrandStats_::round_ticks(size_t n)
+{
+	_roundTicks.record((long long)n);
+}
+
+strand_stats StrandStats_::snapshot(bool reset)
+{
+	strand_stats res;
+	std::lock_guard<std::mutex> lg(_readMutex);
+	_queueWait.snapshot(res.queueWait, _base.queueWait, reset);
+	_runTime.snapshot(res.runTime, _base.runTime, reset);
+	_roundTicks.snapshot(res.roundTicks, _base.roundTicks, reset);
+	return res;
+}
+//////////////////////////////////////////////////////////////////////////
+
+void StrandStatsSink_::queue_wait(long long ns)
+{
+	if (_thread)
+	{
+		_thread->queue_wait(ns);
+	}
+	if (_strand)
+	{
+		_strand->queue_wait(ns);
+	}
+}
+
+void StrandStatsSink_::run_time(long long ns)
+{
+	if (_thread)
+	{
+		_thread->run_time(ns);
+	}
+	if (_strand)
+	{
+		_strand->run_time(ns);
+	}
+}
+
+void StrandStatsSink_::round_ticks(size_t n)
+{
+	if (_thread)
+	{
+		_thread->round_ticks(n);
+	}
+	if (_strand)
+	{
+		_strand->round_ticks(n);
+	}
+}
+
+#endif //ENABLE_STRAND_STATS
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef __STRAND_STATS_H
+#define __STRAND_STATS_H
+
+#ifdef ENABLE_STRAND_STATS
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "scattered.h"
+
+//ֱͼÿ2ϸΪ2^(STATS_SUB_BITS-1)Ͱ
+#ifndef STATS_SUB_BITS
+#define STATS_SUB_BITS 4
+#endif
+
+#define STATS_BUCKET_NUM ((65 - STATS_SUB_BITS) << (STATS_SUB_BITS - 1))
+
+/*!
+@brief ֱͼ
+*/
+struct histogram_snapshot
+{
+	histogram_snapshot();
+
+	/*!
+	@brief ٷλ(0~100)ͰϽ
+	*/
+	long long percentile(double p) const;
+
+	/*!
+	@brief ƽֵ
+	*/
+	double mean() const;
+
+	/*!
+	@brief ϲһ
+	*/
+	void merge(const histogram_snapshot& other);
+
+	long long count;
+	long long sum;
+	long long max;
+	std::vector<long long> buckets;
+};
+
+/*!
+@brief strandͳƣʱ䵥λΪ
+*/
+struct strand_stats
+{
+	histogram_snapshot queueWait;//Ͷݵʼִеĵȴʱ
+	histogram_snapshot runTime;//ִʱ
+	histogram_snapshot roundTicks;//ÿִе
+};
+
+/*!
+@brief HDRʽֱͼ2ݷֶΡϸ֣1/2^(STATS_SUB_BITS-1)
+ͬһʱֻһ̼߳¼¼ԭӶд̶߳ȡ
+*/
+class StatsHistogram_
+{
+public:
+	StatsHistogram_();
+public:
+	void record(long long value);
+
+	/*!
+	@brief ȡbaseļ¼resetʱbaseƵǰλ(¼ļֻ)
+	*/
+	void snapshot(histogram_snapshot& res, histogram_snapshot& base, bool reset);
+	static size_t bucket_index(long long value);
+	static long long bucket_upper(size_t index);
+private:
+	std::atomic<long long> _buckets[STATS_BUCKET_NUM];
+	std::atomic<long long> _count;
+	std::atomic<long long> _sum;
+	std::atomic<long long> _max;
+	NONE_COPY(StatsHistogram_);
+};
+
+/*!
+@brief һ߳(һͳƵstrand)ĵͳƣͬһʱֻһ̼߳¼
+*/
+class StrandStats_
+{
+public:
+	StrandStats_();
+public:
+	void queue_wait(long long ns);
+	void run_time(long long ns);
+	void round_ticks(size_t n);
+	strand_stats snapshot(bool reset);
+private:
+	std::mutex _readMutex;
+	strand_stats _base;
+	StatsHistogram_ _queueWait;
+	StatsHistogram_ _runTime;
+	StatsHistogram_ _roundTicks;
+	NONE_COPY(StrandStats_);
+};
+
+/*!
+@brief strandִʱļ¼Ŀ꣬ͬʱ뵱ǰ̵߳Ļܺstrandͳ(δʱΪNULL)
+*/
+struct StrandStatsSink_
+{
+	void queue_wait(long long ns);
+	void run_time(long long ns);
+	void round_ticks(size_t n);
+
+	StrandStats_* _thread;
+	StrandStats_* _strand;
+};
+
+#endif //ENABLE_STRAND_STATS
+
+#endif
\ No newline at end of file
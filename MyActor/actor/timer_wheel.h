@@ -0,0 +1,404 @@
+#ifndef __TIMER_WHEEL_H
+#define __TIMER_WHEEL_H
+
+#include <algorithm>
+#include <vector>
+#include "mem_pool.h"
+#include "scattered.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//ʱС̶(΢)ͬһ̶ڵĶʱ԰ȷ޴
+#ifndef TIMER_WHEEL_TICK_US
+#define TIMER_WHEEL_TICK_US 1000
+#endif
+
+//ʱֲÿ64ۣĬ5㸲Լ12죬ԶĶʱ
+#ifndef TIMER_WHEEL_LEVELS
+#define TIMER_WHEEL_LEVELS 5
+#endif
+
+/*!
+@brief ֲʱ֣ɾΪO(1)÷msg_multimap<long long, T>(ڵfirstΪޣsecondΪֵ)
+һ̶ڵڵĽڵȡ(ͬް˳)źú
+*/
+template <typename T>
+class TimerWheel_
+{
+	enum
+	{
+		wheel_bits = 6,
+		slot_count = 1 << wheel_bits,
+		slot_mask = slot_count - 1,
+		level_overflow = TIMER_WHEEL_LEVELS,//
+		level_due = TIMER_WHEEL_LEVELS + 1//ѵ
+	};
+public:
+	struct node
+	{
+		template <typename Arg>
+		node(long long et, Arg&& val)
+			:first(et), second(std::forward<Arg>(val)) {}
+
+		long long first;
+		T second;
+	private:
+		friend TimerWheel_;
+		node* _next;
+		node** _pprev;
+		unsigned long long _seq;
+		size_t _level;
+		size_t _slot;
+	};
+	typedef node* iterator;
+private:
+	typedef mem_alloc<node> allocator;
+public:
+	TimerWheel_(size_t poolSize = sizeof(void*))
+		:_alloc(poolSize), _overflow(NULL), _due(NULL), _currTick(0), _scanTime(0), _seq(0), _size(0)
+	{
+		memset(_slots, 0, sizeof(_slots));
+		memset(_bitmap, 0, sizeof(_bitmap));
+		memset(_levelCount, 0, sizeof(_levelCount));
+	}
+
+	~TimerWheel_()
+	{
+		assert(!_size);
+		for (size_t level = 0; level < TIMER_WHEEL_LEVELS; level++)
+		{
+			delete[] _slots[level];
+		}
+	}
+public:
+	/*!
+	@brief һʱ޲ɨʱֱ뵽
+	*/
+	template <typename Arg>
+	iterator insert(long long et, Arg&& val)
+	{
+		if (!_size)
+		{//ֱӲǰʱ䣬ƽ
+			_currTick = std::max(_currTick, get_tick_us() / TIMER_WHEEL_TICK_US);
+		}
+		node* const newNode = new(_alloc.allocate())node(et, std::forward<Arg>(val));
+		newNode->_seq = _seq++;
+		_size++;
+		if (et <= _scanTime)
+		{
+			node** pp = &_due;
+			while (*pp && (*pp)->first <= et)
+			{
+				pp = &(*pp)->_next;
+			}
+			link(pp, newNode);
+			newNode->_level = level_due;
+			_levelCount[level_due]++;
+		}
+		else
+		{
+			place(newNode);
+		}
+		return newNode;
+	}
+
+	/*!
+	@brief ɾһʱ
+	*/
+	void erase(iterator it)
+	{
+		assert(_size);
+		unlink(it);
+		if (it->_level < TIMER_WHEEL_LEVELS && !slot_head(it->_level, it->_slot))
+		{
+			_bitmap[it->_level] &= ~(1ULL << it->_slot);
+		}
+		_levelCount[it->_level]--;
+		_size--;
+		it->~node();
+		_alloc.deallocate(it);
+	}
+
+	/*!
+	@brief ƽctʱ̣ĵڽڵ(޲ct)ûзNULL
+	ڵ㴦ɵ÷eraseȡǰƽ
+	*/
+	iterator expire(long long ct)
+	{
+		if (!_due && _size && ct > _scanTime)
+		{
+			advance(ct);
+			_scanTime = ct;
+		}
+		return _due;
+	}
+
+	/*!
+	@brief һҪѵʱ䣬ͲΪʱϲ۵·ʱ
+	*/
+	long long next_time() const
+	{
+		assert(_size);
+		if (_due)
+		{
+			return _due->first;
+		}
+		if (_levelCount[0])
+		{
+			const size_t slot = low_bit(_bitmap[0] & (~0ULL << (size_t)(_currTick & slot_mask)));
+			long long et = slot_head(0, slot)->first;
+			for (node* it = slot_head(0, slot)->_next; it; it = it->_next)
+			{
+				et = std::min(et, it->first);
+			}
+			return et;
+		}
+		for (size_t level = 1; level < TIMER_WHEEL_LEVELS; level++)
+		{
+			if (_levelCount[level])
+			{
+				const size_t slot = low_bit(_bitmap[level] & (~0ULL << (size_t)((_currTick >> (wheel_bits * level)) & slot_mask)));
+				const size_t upShift = wheel_bits * (level + 1);
+				return (((_currTick >> upShift) << upShift) | ((long long)slot << (wheel_bits * level))) * TIMER_WHEEL_TICK_US;
+			}
+		}
+		return (((_currTick >> (wheel_bits * TIMER_WHEEL_LEVELS)) + 1) << (wheel_bits * TIMER_WHEEL_LEVELS)) * TIMER_WHEEL_TICK_US;
+	}
+
+	/*!
+	@brief ֿʱͷŵ1ϵĲ飬ʱ˳ѭʱã
+	0(̶ʱÿζõ)Ͳ򻺳屣Ƶ˯߻ѵstrandÿζ·
+	*/
+	void shrink()
+	{
+		assert(!_size);
+		for (size_t level = 1; level < TIMER_WHEEL_LEVELS; level++)
+		{
+			delete[] _slots[level];
+			_slots[level] = NULL;
+		}
+		_sortBuff.clear();
+		if (_sortBuff.capacity() > slot_count)
+		{
+			_sortBuff.shrink_to_fit();
+		}
+	}
+
+	size_t size() const
+	{
+		return _size;
+	}
+
+	bool empty() const
+	{
+		return !_size;
+	}
+private:
+	static size_t low_bit(unsigned long long value)
+	{
+		assert(value);
+#ifdef _MSC_VER
+		unsigned long i;
+		if (_BitScanForward(&i, (unsigned long)value))
+		{
+			return i;
+		}
+		_BitScanForward(&i, (unsigned long)(value >> 32));
+		return (size_t)i + 32;
+#else
+		return __builtin_ctzll(value);
+#endif
+	}
+
+	static void link(node** pp, node* newNode)
+	{
+		newNode->_next = *pp;
+		newNode->_pprev = pp;
+		if (*pp)
+		{
+			(*pp)->_pprev = &newNode->_next;
+		}
+		*pp = newNode;
+	}
+
+	static void unlink(node* it)
+	{
+		*it->_pprev = it->_next;
+		if (it->_next)
+		{
+			it->_next->_pprev = it->_pprev;
+		}
+	}
+
+	node*& slot_head(size_t level, size_t slot) const
+	{
+		assert(_slots[level]);
+		return _slots[level][slot];
+	}
+
+	/*!
+	@brief 뵱ǰ̶ȵληӦ
+	*/
+	void place(node* it)
+	{
+		const long long tick = std::max(it->first / TIMER_WHEEL_TICK_US, _currTick);
+		const unsigned long long diff = (unsigned long long)(tick ^ _currTick);
+		size_t level = 0;
+		while (level < TIMER_WHEEL_LEVELS && (diff >> (wheel_bits * (level + 1))))
+		{
+			level++;
+		}
+		if (TIMER_WHEEL_LEVELS == level)
+		{
+			link(&_overflow, it);
+			it->_level = level_overflow;
+		}
+		else
+		{
+			if (!_slots[level])
+			{//ÿĲ״õʱ
+				_slots[level] = new node*[slot_count]();
+			}
+			const size_t slot = (size_t)(tick >> (wheel_bits * level)) & slot_mask;
+			link(&slot_head(level, slot), it);
+			_bitmap[level] |= 1ULL << slot;
+			it->_level = level;
+			it->_slot = slot;
+		}
+		_levelCount[it->_level]++;
+	}
+
+	/*!
+	@brief ƽctڿ̶ȣԽϲ۱߽ʱ·ţڼ䵽ڵĽڵ뵽
+	*/
+	void advance(long long ct)
+	{
+		assert(!_due);
+		const long long nowTick = ct / TIMER_WHEEL_TICK_US;
+		_sortBuff.clear();
+		collect(ct);
+		while (_currTick < nowTick)
+		{
+			if (_levelCount[0])
+			{
+				_currTick++;
+			}
+			else
+			{//ͲΪգֱһǿղһ߽
+				size_t level = 1;
+				while (level < TIMER_WHEEL_LEVELS && !_levelCount[level])
+				{
+					level++;
+				}
+				if (TIMER_WHEEL_LEVELS == level && !_levelCount[level_overflow])
+				{
+					_currTick = nowTick;
+					break;
+				}
+				const size_t shift = wheel_bits * level;
+				_currTick = std::min(((_currTick >> shift) + 1) << shift, nowTick);
+			}
+			cascade();
+			collect(ct);
+		}
+		if (!_sortBuff.empty())
+		{
+			std::sort(_sortBuff.begin(), _sortBuff.end(), [](const node* a, const node* b)
+			{
+				return a->first < b->first || (a->first == b->first && a->_seq < b->_seq);
+			});
+			for (size_t i = _sortBuff.size(); i > 0; i--)
+			{
+				node* const it = _sortBuff[i - 1];
+				link(&_due, it);
+				it->_level = level_due;
+			}
+			_levelCount[level_due] += _sortBuff.size();
+		}
+	}
+
+	/*!
+	@brief ȡǰ̶Ȳ޲ctĽڵ
+	*/
+	void collect(long long ct)
+	{
+		if (!_levelCount[0])
+		{
+			return;
+		}
+		const size_t slot = (size_t)(_currTick & slot_mask);
+		node** pp = &slot_head(0, slot);
+		while (*pp)
+		{
+			node* const it = *pp;
+			if (it->first <= ct)
+			{
+				unlink(it);
+				_levelCount[0]--;
+				_sortBuff.push_back(it);
+			}
+			else
+			{
+				pp = &it->_next;
+			}
+		}
+		if (!slot_head(0, slot))
+		{
+			_bitmap[0] &= ~(1ULL << slot);
+		}
+	}
+
+	/*!
+	@brief ǰ̶ϲ߽ʱϲӦ()Ľڵ·
+	*/
+	void cascade()
+	{
+		for (size_t level = 1; level <= TIMER_WHEEL_LEVELS; level++)
+		{
+			if (_currTick & ((1LL << (wheel_bits * level)) - 1))
+			{
+				break;
+			}
+			node* list;
+			if (level < TIMER_WHEEL_LEVELS)
+			{
+				if (!_levelCount[level])
+				{
+					continue;
+				}
+				const size_t slot = (size_t)(_currTick >> (wheel_bits * level)) & slot_mask;
+				list = slot_head(level, slot);
+				slot_head(level, slot) = NULL;
+				_bitmap[level] &= ~(1ULL << slot);
+			}
+			else
+			{
+				list = _overflow;
+				_overflow = NULL;
+			}
+			while (list)
+			{
+				node* const it = list;
+				list = it->_next;
+				_levelCount[it->_level]--;
+				place(it);
+			}
+		}
+	}
+private:
+	allocator _alloc;
+	node** _slots[TIMER_WHEEL_LEVELS];//ÿ64ۣ
+	node* _overflow;
+	node* _due;
+	long long _currTick;//ƽĿ̶
+	long long _scanTime;//ɨ赽ʱ䣬޲ڴ˵Ľڵ㶼ڵ
+	unsigned long long _seq;
+	size_t _size;
+	unsigned long long _bitmap[TIMER_WHEEL_LEVELS];
+	size_t _levelCount[TIMER_WHEEL_LEVELS + 2];
+	std::vector<node*> _sortBuff;
+	NONE_COPY(TimerWheel_);
+};
+
+#endif
\ No newline at end of file
@@ -1,18 +1,19 @@
 #ifdef DISABLE_BOOST_TIMER
 #include "waitable_timer.h"
 #include "scattered.h"
+#include "io_engine.h"
 #ifdef WIN32
 #include <Windows.h>
 
-WaitableTimer_::WaitableTimer_()
+WaitableTimer_::timer_shard::timer_shard()
 :_eventsQueue(1024), _exited(false), _extMaxTick(0), _extFinishTime(-1),
-_timerHandle(CreateWaitableTimer(NULL, FALSE, NULL))
+_timerHandle(CreateWaitableTimer(NULL, FALSE, NULL)), _stats()
 {
 	run_thread th([this] { timerThread(); });
 	_timerThread.swap(th);
 }
 
-WaitableTimer_::~WaitableTimer_()
+WaitableTimer_::timer_shard::~timer_shard()
 {
 	{
 		std::lock_guard<std::mutex> lg(_ctrlMutex);
@@ -26,77 +27,47 @@ WaitableTimer_::~WaitableTimer_()
 	CloseHandle(_timerHandle);
 }
 
-void WaitableTimer_::appendEvent(long long abs, long long rel, WaitableTimerEvent_* h)
+void WaitableTimer_::timer_shard::setTimer(long long abs, long long rel)
 {
-	assert(h->_timerHandle._null);
-	h->_timerHandle._null = false;
-	std::lock_guard<std::mutex> lg(_ctrlMutex);
-	if (abs >= _extMaxTick)
-	{
-		_extMaxTick = abs;
-		h->_timerHandle._queueNode = _eventsQueue.insert(_eventsQueue.end(), std::make_pair(abs, h));
-	}
-	else
-	{
-		h->_timerHandle._queueNode = _eventsQueue.insert(std::make_pair(abs, h));
-	}
-	if ((unsigned long long)abs < (unsigned long long)_extFinishTime)
-	{
-		_extFinishTime = abs;
-		LARGE_INTEGER sleepTime;
-		sleepTime.QuadPart = -(LONGLONG)(rel * 10);
-		SetWaitableTimer(_timerHandle, &sleepTime, 0, NULL, NULL, FALSE);
-	}
+	LARGE_INTEGER sleepTime;
+	sleepTime.QuadPart = -(LONGLONG)(rel * 10);
+	SetWaitableTimer(_timerHandle, &sleepTime, 0, NULL, NULL, FALSE);
 }
 
-void WaitableTimer_::timerThread()
+void WaitableTimer_::timer_shard::timerThread()
 {
 	run_thread::set_current_thread_name("waitable timer thread");
 	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+	__space_align void* tlsBuff[64] = { 0 };
+	io_engine::setTlsBuff(tlsBuff);
+	std::vector<expired_event> expired;
+	expired.reserve(256);
 	while (true)
 	{
 		if (WAIT_OBJECT_0 == WaitForSingleObject(_timerHandle, INFINITE) && !_exited)
 		{
-			long long ct = get_tick_us();
-			std::lock_guard<std::mutex> lg(_ctrlMutex);
-			_extFinishTime = -1;
-			while (!_eventsQueue.empty())
-			{
-				handler_queue::iterator iter = _eventsQueue.begin();
-				if (iter->first > ct)
-				{
-					_extFinishTime = iter->first;
-					LARGE_INTEGER sleepTime;
-					sleepTime.QuadPart = -(LONGLONG)((iter->first - ct) * 10);
-					SetWaitableTimer(_timerHandle, &sleepTime, 0, NULL, NULL, FALSE);
-					break;
-				} 
-				else
-				{
-					iter->second->eventHandler();
-					_eventsQueue.erase(iter);
-				}
-			}
+			fireEvents(expired);
 		} 
 		else
 		{
 			break;
 		}
 	}
+	io_engine::setTlsBuff(NULL);
 }
 #elif __linux__
 #include <sys/timerfd.h>
 #include <pthread.h>
 
-WaitableTimer_::WaitableTimer_()
+WaitableTimer_::timer_shard::timer_shard()
 :_eventsQueue(1024), _exited(false), _extMaxTick(0), _extFinishTime(-1),
-_timerFd(timerfd_create(CLOCK_MONOTONIC, 0))
+_timerFd(timerfd_create(CLOCK_MONOTONIC, 0)), _stats()
 {
 	run_thread th([this] { timerThread(); });
 	_timerThread.swap(th);
 }
 
-WaitableTimer_::~WaitableTimer_()
+WaitableTimer_::timer_shard::~timer_shard()
 {
 	{
 		std::lock_guard<std::mutex> lg(_ctrlMutex);
@@ -109,32 +80,16 @@ WaitableTimer_::~WaitableTimer_()
 	close(_timerFd);
 }
 
-void WaitableTimer_::appendEvent(long long abs, long long rel, WaitableTimerEvent_* h)
+void WaitableTimer_::timer_shard::setTimer(long long abs, long long rel)
 {
-	assert(h->_timerHandle._null);
-	h->_timerHandle._null = false;
-	std::lock_guard<std::mutex> lg(_ctrlMutex);
-	if (abs >= _extMaxTick)
-	{
-		_extMaxTick = abs;
-		h->_timerHandle._queueNode = _eventsQueue.insert(_eventsQueue.end(), std::make_pair(abs, h));
-	}
-	else
-	{
-		h->_timerHandle._queueNode = _eventsQueue.insert(std::make_pair(abs, h));
-	}
-	if ((unsigned long long)abs < (unsigned long long)_extFinishTime)
-	{
-		_extFinishTime = abs;
-		struct itimerspec newValue;
-		newValue.it_interval = { 0, 0 };
-		newValue.it_value.tv_sec = (__time_t)(abs / 1000000);
-		newValue.it_value.tv_nsec = (long)(abs % 1000000) * 1000;
-		timerfd_settime(_timerFd, TFD_TIMER_ABSTIME, &newValue, NULL);
-	}
+	struct itimerspec newValue;
+	newValue.it_interval = { 0, 0 };
+	newValue.it_value.tv_sec = (__time_t)(abs / 1000000);
+	newValue.it_value.tv_nsec = (long)(abs % 1000000) * 1000;
+	timerfd_settime(_timerFd, TFD_TIMER_ABSTIME, &newValue, NULL);
 }
 
-void WaitableTimer_::timerThread()
+void WaitableTimer_::timer_shard::timerThread()
 {
 	run_thread::set_current_thread_name("waitable timer thread");
 	pthread_attr_t threadAttr;
@@ -142,44 +97,50 @@ void WaitableTimer_::timerThread()
 	pthread_attr_init(&threadAttr);
 	pthread_attr_setschedpolicy(&threadAttr, SCHED_FIFO);
 	pthread_attr_setschedparam(&threadAttr, &pm);
+	__space_align void* tlsBuff[64] = { 0 };
+	io_engine::setTlsBuff(tlsBuff);
+	std::vector<expired_event> expired;
+	expired.reserve(256);
 	long long exp = 0;
 	while (true)
 	{
 		if (sizeof(exp) == read(_timerFd, &exp, sizeof(exp)) && !_exited)
 		{
-			long long ct = get_tick_us();
-			std::lock_guard<std::mutex> lg(_ctrlMutex);
-			_extFinishTime = -1;
-			while (!_eventsQueue.empty())
-			{
-				handler_queue::iterator iter = _eventsQueue.begin();
-				if (iter->first > ct)
-				{
-					_extFinishTime = iter->first;
-					struct itimerspec newValue;
-					newValue.it_interval = { 0, 0 };
-					newValue.it_value.tv_sec = (__time_t)(_extFinishTime / 1000000);
-					newValue.it_value.tv_nsec = (long)(_extFinishTime % 1000000) * 1000;
-					timerfd_settime(_timerFd, TFD_TIMER_ABSTIME, &newValue, NULL);
-					break;
-				}
-				else
-				{
-					iter->second->eventHandler();
-					_eventsQueue.erase(iter);
-				}
-			}
+			fireEvents(expired);
 		}
 		else
 		{
 			break;
 		}
 	}
+	io_engine::setTlsBuff(NULL);
 	pthread_attr_destroy(&threadAttr);
 }
 #endif
 
-void WaitableTimer_::removeEvent(timer_handle& th)
+void WaitableTimer_::timer_shard::appendEvent(long long abs, long long rel, WaitableTimerEvent_* h)
+{
+	assert(h->_timerHandle._null);
+	h->_timerHandle._null = false;
+	std::lock_guard<std::mutex> lg(_ctrlMutex);
+	_stats.appendCount++;
+	if (abs >= _extMaxTick)
+	{
+		_extMaxTick = abs;
+		h->_timerHandle._queueNode = _eventsQueue.insert(_eventsQueue.end(), std::make_pair(abs, h));
+	}
+	else
+	{
+		h->_timerHandle._queueNode = _eventsQueue.insert(std::make_pair(abs, h));
+	}
+	if ((unsigned long long)abs < (unsigned long long)_extFinishTime)
+	{
+		_extFinishTime = abs;
+		setTimer(abs, rel);
+	}
+}
+
+void WaitableTimer_::timer_shard::removeEvent(timer_handle& th)
 {
 	std::lock_guard<std::mutex> lg(_ctrlMutex);
 	if (!th._null)
@@ -207,27 +168,100 @@ void WaitableTimer_::removeEvent(timer_handle& th)
 		}
 	}
 }
+
+void WaitableTimer_::timer_shard::fireEvents(std::vector<expired_event>& expired)
+{
+	{
+		long long ct = get_tick_us();
+		std::lock_guard<std::mutex> lg(_ctrlMutex);
+		_stats.wakeCount++;
+		_extFinishTime = -1;
+		while (!_eventsQueue.empty())
+		{
+			handler_queue::iterator iter = _eventsQueue.begin();
+			if (iter->first > ct)
+			{
+				_extFinishTime = iter->first;
+				setTimer(_extFinishTime, _extFinishTime - ct);
+				break;
+			}
+			else
+			{
+				//ڽȴ״̬˺cancelٴcancel_eventصƳٵ
+				WaitableTimerEvent_* const h = iter->second;
+				h->_timerHandle.reset();
+				h->_triged = true;
+				expired_event ev = { h->_timerBoost, h->_tcId };
+				expired.push_back(ev);
+				_stats.maxLate = std::max(_stats.maxLate, ct - iter->first);
+				_eventsQueue.erase(iter);
+			}
+		}
+		_stats.fireCount += expired.size();
+		_stats.maxBatch = std::max(_stats.maxBatch, (long long)expired.size());
+		_stats.maxHold = std::max(_stats.maxHold, get_tick_us() - ct);
+	}
+	//ͬһstrandĵ¼ϲ
+	post_batch_scope batchScope;
+	for (expired_event& ele : expired)
+	{
+		ele._timerBoost->post_event(ele._tcId);
+	}
+	expired.clear();
+}
+
+void WaitableTimer_::timer_shard::getStats(waitable_timer_stats& stats)
+{
+	std::lock_guard<std::mutex> lg(_ctrlMutex);
+	stats = _stats;
+	stats.events = _eventsQueue.size();
+}
 //////////////////////////////////////////////////////////////////////////
 
-WaitableTimerEvent_::WaitableTimerEvent_(io_engine& ios, TimerBoostCompletedEventFace_* timerBoost)
-:_ios(ios), _timerBoost(timerBoost), _tcId(-1), _triged(true) {}
+WaitableTimer_::WaitableTimer_()
+{
+	for (size_t i = 0; i < WAITABLE_TIMER_SHARDS; i++)
+	{
+		_shards[i] = new timer_shard();
+	}
+}
 
-WaitableTimerEvent_::~WaitableTimerEvent_()
+WaitableTimer_::~WaitableTimer_()
 {
-	assert(_triged);
+	for (size_t i = 0; i < WAITABLE_TIMER_SHARDS; i++)
+	{
+		delete _shards[i];
+	}
+}
+
+WaitableTimer_::timer_shard* WaitableTimer_::getShard(const void* key)
+{
+	return _shards[address_hash(key) % WAITABLE_TIMER_SHARDS];
 }
 
-void WaitableTimerEvent_::eventHandler()
+std::vector<waitable_timer_stats> WaitableTimer_::getStats()
 {
-	_timerHandle.reset();
-	_triged = true;
-	_timerBoost->post_event(_tcId);
+	std::vector<waitable_timer_stats> res(WAITABLE_TIMER_SHARDS);
+	for (size_t i = 0; i < WAITABLE_TIMER_SHARDS; i++)
+	{
+		_shards[i]->getStats(res[i]);
+	}
+	return res;
+}
+//////////////////////////////////////////////////////////////////////////
+
+WaitableTimerEvent_::WaitableTimerEvent_(io_engine& ios, const void* key, TimerBoostCompletedEventFace_* timerBoost)
+:_shard(ios._waitableTimer->getShard(key)), _timerBoost(timerBoost), _tcId(-1), _triged(true) {}
+
+WaitableTimerEvent_::~WaitableTimerEvent_()
+{
+	assert(_triged);
 }
 
 void WaitableTimerEvent_::cancel(boost::system::error_code& ec)
 {
 	ec.clear();
-	_ios._waitableTimer->removeEvent(_timerHandle);
+	_shard->removeEvent(_timerHandle);
 	if (!_triged)
 	{
 		_triged = true;
@@ -240,7 +274,7 @@ void WaitableTimerEvent_::async_wait(long long abs, long long rel, int tc)
 	assert(_triged);
 	_triged = false;
 	_tcId = tc;
-	_ios._waitableTimer->appendEvent(abs, rel, this);
+	_shard->appendEvent(abs, rel, this);
 }
 
 #endif
\ No newline at end of file
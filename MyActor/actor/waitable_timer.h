@@ -7,9 +7,15 @@
 #include "run_strand.h"
 #include "run_thread.h"
 
+//ʱƬÿƬһʱ̺߳һ޶УʱstrandɢеƬ
+#ifndef WAITABLE_TIMER_SHARDS
+#define WAITABLE_TIMER_SHARDS 4
+#endif
+
 class ActorTimer_;
 class WaitableTimerEvent_;
 class overlap_timer;
+struct TimerBoostCompletedEventFace_;
 
 class WaitableTimer_
 {
@@ -26,27 +32,53 @@ class WaitableTimer_
 		handler_queue::iterator _queueNode;
 	};
 
+	//ѵڴص¼Ͷ
+	struct expired_event
+	{
+		TimerBoostCompletedEventFace_* _timerBoost;
+		int _tcId;
+	};
+
+	class timer_shard
+	{
+		friend WaitableTimer_;
+		friend WaitableTimerEvent_;
+	private:
+		timer_shard();
+		~timer_shard();
+	private:
+		void appendEvent(long long abs, long long rel, WaitableTimerEvent_* h);
+		void removeEvent(timer_handle& th);
+		void setTimer(long long abs, long long rel);
+		void fireEvents(std::vector<expired_event>& expired);
+		void timerThread();
+		void getStats(waitable_timer_stats& stats);
+	private:
+		long long _extMaxTick;
+		long long _extFinishTime;
+		handler_queue _eventsQueue;
+		std::mutex _ctrlMutex;
+		run_thread _timerThread;
+#ifdef WIN32
+		void* _timerHandle;
+#elif __linux__
+		int _timerFd;
+#endif
+		waitable_timer_stats _stats;
+		volatile bool _exited;
+		NONE_COPY(timer_shard);
+	};
+
 	friend io_engine;
 	friend WaitableTimerEvent_;
 private:
 	WaitableTimer_();
 	~WaitableTimer_();
 private:
-	void appendEvent(long long abs, long long rel, WaitableTimerEvent_* h);
-	void removeEvent(timer_handle& th);
-	void timerThread();
+	timer_shard* getShard(const void* key);
+	std::vector<waitable_timer_stats> getStats();
 private:
-	long long _extMaxTick;
-	long long _extFinishTime;
-	handler_queue _eventsQueue;
-	std::mutex _ctrlMutex;
-	run_thread _timerThread;
-#ifdef WIN32
-	void* _timerHandle;
-#elif __linux__
-	int _timerFd;
-#endif
-	volatile bool _exited;
+	timer_shard* _shards[WAITABLE_TIMER_SHARDS];
 	NONE_COPY(WaitableTimer_);
 };
 
@@ -56,14 +88,13 @@ class WaitableTimerEvent_
 	friend WaitableTimer_;
 	friend overlap_timer;
 private:
-	WaitableTimerEvent_(io_engine& ios, TimerBoostCompletedEventFace_* timerBoost);
+	WaitableTimerEvent_(io_engine& ios, const void* key, TimerBoostCompletedEventFace_* timerBoost);
 	~WaitableTimerEvent_();
 private:
-	void eventHandler();
 	void cancel(boost::system::error_code& ec);
 	void async_wait(long long abs, long long rel, int tc);
 private:
-	io_engine& _ios;
+	WaitableTimer_::timer_shard* const _shard;
 	WaitableTimer_::timer_handle _timerHandle;
 	TimerBoostCompletedEventFace_* _timerBoost;
 	int _tcId;